@@ -14,6 +14,25 @@ namespace cfg {
     inline constexpr uint32_t UART_BAUD     = 115200;   // 115200 baudios (configuración estándar ESP8266)
     inline constexpr int      UART_TX_PIN   = 4;        // Pico GP4 TX -> ESP RX
     inline constexpr int      UART_RX_PIN   = 5;        // Pico GP5 RX <- ESP TX
+    // Control de flujo RTS/CTS (-1 = sin cablear). En uart1: GP10 CTS <- ESP
+    // GPIO15 (RTS) y GP11 RTS -> ESP GPIO13 (CTS); GP6/GP7 (las otras de
+    // uart1) ya son PIN_GPIO2 y PIN_EN_CH_PD. Con él, el ESP para de
+    // enviar mientras la ISR de RX no puede vaciar la FIFO (borrados de flash).
+    inline constexpr int      UART_CTS_PIN  = -1;
+    inline constexpr int      UART_RTS_PIN  = -1;
+    // Tras el "AT" a UART_BAUD se sube con AT+UART_CUR a la primera de estas
+    // velocidades que pase la verificación; si ninguna, se queda en UART_BAUD.
+    // El ESP vuelve a UART_BAUD al reiniciarse. Con el diario en flash activo
+    // (JOURNAL_SECTORS) y sin RTS/CTS se saltan las velocidades que llenan la
+    // FIFO RX (32 bytes) antes de que acabe una página programada, que para
+    // las interrupciones de core0: 230400 deja ~1,4 ms; 460800 y 921600, no.
+    inline constexpr uint32_t UART_FAST_BAUDS[] = {921600, 460800, 230400};
+    inline constexpr uint32_t UART_FLASH_STALL_US = 1000;  // programar una página de flash (~1 ms)
+    inline constexpr int      UART_VERIFY_ROUNDS = 3;   // "AT" seguidos con OK a la nueva velocidad
+    // A velocidad alta, un reinicio del ESP se delata con una ráfaga de
+    // errores de trama (su banner a otra velocidad); uno suelto es ruido
+    inline constexpr uint32_t UART_REBOOT_FRAMING_ERRORS = 8;
+    inline constexpr uint32_t UART_REBOOT_WINDOW_MS      = 100;
     inline uart_inst_t* UART() { return (UART_INDEX == 0) ? uart0 : uart1; }
 
     // ===== Wi-Fi (ESP8266 con firmware AT) =====
@@ -32,13 +51,19 @@ namespace cfg {
     inline constexpr int  HTTP_PORT         = 80;
     inline constexpr bool SINGLE_CONNECTION = false;    // informativo
     inline constexpr int  SERVER_IDLE_TIMEOUT_S = 10;
+    inline constexpr int  CIPSEND_MAX_BYTES = 2048;     // límite de un CIPSEND del firmware AT
 
     // ===== Buffers =====
     inline constexpr int  REQ_BUFFER_SIZE   = 1024;
     inline constexpr int  AT_CMD_MAX_LEN    = 64;
 
     // ===== Log por USB (stdio) =====
-    inline constexpr bool LOG_TO_USB        = true;
+    inline constexpr bool LOG_TO_USB        = true;     // eco del tráfico con el ESP (módulo ESP a DEBUG)
+    // Nivel inicial de cada módulo: 0 nada, 1 errores, 2 avisos, 3 info,
+    // 4 depuración (p. ej. la última muestra de cada lote del sensor)
+    inline constexpr int  LOG_LEVEL         = 3;
+    inline constexpr uint32_t LOG_RING_RECORDS = 64;    // registros por core (potencia de dos)
+    inline constexpr uint32_t LOG_DRAIN_INTERVAL_MS = 10;
 
     // ===== Pines de control ESP8266 =====
     inline constexpr int  PIN_EN_CH_PD      = 7;        // GP7 - Pin ENABLE del ESP8266 (HIGH para habilitar)
@@ -51,6 +76,8 @@ namespace cfg {
     inline constexpr int  API_PORT         = 3000;             
     inline constexpr char API_ENDPOINT[]   = "/api/pico/sensor-data";
     inline constexpr char DEVICE_ID[]      = "pico_sensor_01";
+    inline constexpr int  API_LINK_ID      = 4;                // enlace CIPMUX reservado para la API
+    inline constexpr int  API_RESPONSE_TIMEOUT_MS = 3000;      // espera de la respuesta HTTP
     
     // ===== Sensor MPU6050 =====
     inline constexpr int   MPU6050_SDA_PIN = 21;          
@@ -58,18 +85,80 @@ namespace cfg {
     inline constexpr int   I2C_INSTANCE    = 0;           
     inline constexpr int   I2C_BAUD_RATE   = 400000;      
     inline constexpr uint8_t MPU6050_ADDR  = 0x68;        
+    inline constexpr int   MPU6050_INT_PIN = 18;          // INT del MPU6050 (DATA_RDY); -1 si no está cableado
     
     // Umbrales de detección (ajustados para detectar movimientos reales)
     inline constexpr float EARTHQUAKE_THRESHOLD = 3.0f;  // m/s² (~0.3g) - movimiento fuerte
     inline constexpr float VIBRATION_THRESHOLD  = 1.5f;  // m/s² (~0.15g) - movimiento suave
-    inline constexpr int   SENSOR_READ_INTERVAL = 100;   
+    inline constexpr int   SAMPLE_RATE_HZ       = 200;   // muestreo por hardware (FIFO del MPU6050)
+    inline constexpr int   FIFO_BATCH_MAX       = 32;    // muestras por ráfaga I2C
+    inline constexpr int   SENSOR_READ_INTERVAL = 50;    // ms entre vaciados de la FIFO (respaldo si no hay INT)
+    inline constexpr int   FIFO_DRAIN_SAMPLES   = 10;    // con DATA_RDY: vaciar en cuanto haya este lote
     inline constexpr int   API_SEND_INTERVAL   = 5000;   
     inline constexpr int   STATUS_SEND_INTERVAL = 30000; 
     
+    // ===== Filtros (biquad por eje, coeficientes en compilación) =====
+    inline constexpr double FILTER_HIGHPASS_HZ = 0.2;    // quita gravedad, inclinación y deriva
+    inline constexpr double FILTER_LOWPASS_HZ  = 25.0;   // límite superior de la banda sísmica
+    inline constexpr bool   FILTER_BANDPASS    = true;   // false: solo paso alto
+    
+    // ===== Detector STA/LTA =====
+    inline constexpr float STA_WINDOW_S            = 0.5f;   // promedio corto
+    inline constexpr float LTA_WINDOW_S            = 30.0f;  // promedio largo (ruido de fondo)
+    inline constexpr float STA_LTA_TRIGGER_RATIO   = 4.0f;
+    inline constexpr float STA_LTA_DETRIGGER_RATIO = 1.5f;
+    inline constexpr float STA_LTA_MIN_LTA         = 0.02f;  // m/s², suelo de la LTA
+    
+    // ===== Ciclo de vida de un evento (lib/EventTracker.h) =====
+    inline constexpr int EVENT_QUIET_S        = 5;     // sin disparo este tiempo: el evento termina
+    inline constexpr int EVENT_MAX_DURATION_S = 120;   // más largo: se cierra y sigue como otro
+    
+    // ===== Captura de forma de onda (pre-disparo + evento) =====
+    // El registro acaba con el evento del tracker (coda = EVENT_QUIET_S)
+    inline constexpr int CAPTURE_PRE_TRIGGER_S  = 10;    // historia previa al disparo
+    inline constexpr int CAPTURE_MAX_RECORD_S   = 30;    // longitud máxima de un registro
+    inline constexpr int CAPTURE_RECORDS        = 2;     // registros en RAM (uno graba, otro sube)
+    inline constexpr const char* API_WAVEFORM_ENDPOINT = "/api/pico/waveform";
+    
+    // ===== Lotes binarios (lib/BatchFormat.h) =====
+    inline constexpr int BATCH_BUFFER_SIZE = 1792;       // bytes por POST (cabe en un CIPSEND de 2 KB)
+    inline constexpr const char* API_BATCH_ENDPOINT = "/api/pico/sensor-batch";
+    
+    // ===== Diario en flash (store-and-forward de eventos y formas de onda) =====
+    inline constexpr int JOURNAL_SECTORS  = 64;          // 256 KB al final de la flash
+    
+    // ===== Cola de salida (alerta > forma de onda > telemetría > estado) =====
+    // Huecos por clase; los reintentos y esperas de cada clase están en
+    // lib/UplinkQueue.cpp
+    inline constexpr int UPLINK_ALERT_SLOTS     = 4;
+    inline constexpr int UPLINK_WAVEFORM_SLOTS  = 2;     // de BATCH_BUFFER_SIZE
+    inline constexpr int UPLINK_TELEMETRY_SLOTS = 3;     // uno se llena, dos esperan
+    inline constexpr int UPLINK_STATUS_SLOTS    = 1;     // el estado nuevo pisa al viejo
+    inline constexpr int UPLINK_ALERT_BYTES     = 512;   // JSON de un evento
+    inline constexpr int UPLINK_STATUS_BYTES    = 640;   // JSON de estado
+    
+    // ===== Stream en vivo (SSE en /api/stream) =====
+    inline constexpr int SSE_MAX_SUBSCRIBERS = 2;        // conexiones abiertas a la vez
+    inline constexpr int SSE_DECIMATION      = 10;       // 200 Hz -> 20 Hz (promedio de bloque)
+    inline constexpr int SSE_BATCH_SAMPLES   = 10;       // muestras decimadas por mensaje (0,5 s)
+    inline constexpr int SSE_KEEPALIVE_MS    = 5000;     // comentario de relleno (< SERVER_IDLE_TIMEOUT_S)
+    
+    // ===== Doble núcleo =====
+    // true: lectura del MPU6050 y detección en core1; core0 solo HTTP y subidas
+    inline constexpr bool DUAL_CORE = true;
+    
+    // ===== Planificador cooperativo (presupuestos por paso, en µs) =====
+    inline constexpr uint32_t TASK_HTTP_BUDGET_US     = 2000;   // espera máxima de +IPD por paso
+    inline constexpr uint32_t TASK_SAMPLING_BUDGET_US = 3000;   // lectura I2C + detección
+    inline constexpr uint32_t TASK_UPLINK_BUDGET_US   = 2000;   // preparar el siguiente envío (la red va en "http")
+    inline constexpr uint32_t TASK_LOG_BUDGET_US      = 1000;   // formatear e imprimir registros del log
+    inline constexpr uint32_t STATUS_PRINT_INTERVAL   = 60000;  // ms, estado por USB
+    
     // Filtros y calibración
     inline constexpr float ACCEL_SCALE_FACTOR = 16384.0f; 
     inline constexpr float GRAVITY = 9.81f;               
     inline constexpr int   CALIBRATION_SAMPLES = 100;     
+    inline constexpr bool  RUN_FIXED_POINT_BENCH = false; // imprime ciclos float vs entero al arrancar
 
 } // namespace cfg
 
@@ -0,0 +1,298 @@
+#include "AsyncHttpClient.h"
+#include "Log.h"
+#include "../Config.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+// Plazos de cada fase (ms)
+static const uint32_t CONNECT_TIMEOUT_MS        = 5000;
+static const uint32_t ALREADY_CONNECTED_GRACE_MS = 200;  // por si sigue un ERROR/OK
+static const uint32_t PROMPT_TIMEOUT_MS         = 2000;
+static const uint32_t SEND_OK_TIMEOUT_MS        = 3000;
+static const uint32_t CLOSE_TIMEOUT_MS          = 1000;
+
+AsyncHttpClient::AsyncHttpClient(int link_id)
+    : io{nullptr, nullptr, nullptr}, link(link_id), next_seq(0), current(-1),
+      phase(IDLE), deadline_us(0), waiting_already_connected(false),
+      is_connected(false), port(0), reused(false), retried(false), header_len(0),
+      connects(0), requests(0), failures(0), last_http_status(0),
+      last_latency(0), max_latency(0) {
+    memset(slots, 0, sizeof(slots));
+    host[0] = '\0';
+}
+
+// ===== API =====
+
+AsyncHttpClient::Handle AsyncHttpClient::submit(const Request& req) {
+    for (int i = 0; i < MAX_REQUESTS; i++) {
+        Slot& s = slots[i];
+        if (s.used) continue;
+        s.req = req;
+        s.used = true;
+        s.gen++;
+        s.state = QUEUED;
+        s.seq = next_seq++;
+        s.submitted_us = time_us_64();
+        s.latency_us = 0;
+        s.http_status = 0;
+        return (Handle)((s.gen << 8) | i);
+    }
+    return INVALID_HANDLE;
+}
+
+AsyncHttpClient::Slot* AsyncHttpClient::slot_for(Handle h) {
+    if (h < 0) return nullptr;
+    int i = h & 0xFF;
+    if (i >= MAX_REQUESTS || !slots[i].used || slots[i].gen != (uint16_t)(h >> 8)) return nullptr;
+    return &slots[i];
+}
+
+const AsyncHttpClient::Slot* AsyncHttpClient::slot_for(Handle h) const {
+    return const_cast<AsyncHttpClient*>(this)->slot_for(h);
+}
+
+AsyncHttpClient::Result AsyncHttpClient::result(Handle h) const {
+    const Slot* s = slot_for(h);
+    if (!s) return Result{UNKNOWN, 0, 0};
+    return Result{s->state, s->http_status, s->latency_us};
+}
+
+void AsyncHttpClient::release(Handle h) {
+    Slot* s = slot_for(h);
+    if (!s) return;
+    // Una petición en vuelo termina igual (el ESP ya tiene el cuerpo o lo
+    // está recibiendo); solo se olvida el resultado
+    if (s->state == IN_FLIGHT) return;
+    s->used = false;
+}
+
+int AsyncHttpClient::pending() const {
+    int n = 0;
+    for (int i = 0; i < MAX_REQUESTS; i++) {
+        if (slots[i].used && (slots[i].state == QUEUED || slots[i].state == IN_FLIGHT)) n++;
+    }
+    return n;
+}
+
+void AsyncHttpClient::poll() {
+    uint64_t now = time_us_64();
+
+    if (phase != IDLE && now >= deadline_us) {
+        if (phase == CONNECTING && waiting_already_connected) {
+            on_connected();
+        } else if (phase == CLOSING) {
+            phase = IDLE;
+            is_connected = false;
+            if (current >= 0) begin_attempt();
+        } else {
+            Log::warn(Log::HTTPC, "Timeout en la fase %d\n", (int)phase);
+            fail();
+            start_close();   // resincronizar con el ESP
+        }
+        return;
+    }
+
+    if (phase != IDLE || current >= 0) return;
+
+    // Siguiente petición por orden de llegada
+    int next = -1;
+    for (int i = 0; i < MAX_REQUESTS; i++) {
+        if (!slots[i].used || slots[i].state != QUEUED) continue;
+        if (next < 0 || (int32_t)(slots[i].seq - slots[next].seq) < 0) next = i;
+    }
+    if (next >= 0) start(next);
+}
+
+// ===== Máquina de estados =====
+
+void AsyncHttpClient::start(int slot) {
+    Slot& s = slots[slot];
+    current = slot;
+    s.state = IN_FLIGHT;
+    retried = false;
+
+    header_len = snprintf(header, sizeof(header),
+        "POST %s HTTP/1.1\r\n"
+        "Host: %s\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %u\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n",
+        s.req.path, s.req.host, s.req.content_type, (unsigned)s.req.body_len);
+    if (header_len <= 0 || header_len >= (int)sizeof(header)) {
+        Log::warn(Log::HTTPC, "Cabecera demasiado larga para %s\n", s.req.path);
+        fail();
+        return;
+    }
+    begin_attempt();
+}
+
+void AsyncHttpClient::begin_attempt() {
+    const Request& req = slots[current].req;
+    bool same_host = port == req.port && strcmp(host, req.host) == 0;
+
+    if (is_connected && !same_host) {
+        start_close();   // al terminar, poll()/on_at_reply vuelven aquí
+        return;
+    }
+
+    reused = is_connected;
+    if (!is_connected) {
+        snprintf(host, sizeof(host), "%s", req.host);
+        port = req.port;
+        waiting_already_connected = false;
+        send_command_for(CONNECTING, CONNECT_TIMEOUT_MS,
+                         "AT+CIPSTART=%d,\"TCP\",\"%s\",%d", link, req.host, req.port);
+        return;
+    }
+    send_command_for(PROMPT, PROMPT_TIMEOUT_MS, "AT+CIPSEND=%d,%d",
+                     link, header_len + (int)req.body_len);
+}
+
+void AsyncHttpClient::send_command_for(Phase next, uint32_t timeout_ms, const char* fmt, ...) {
+    char cmd[128];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(cmd, sizeof(cmd), fmt, ap);
+    va_end(ap);
+
+    phase = next;
+    deadline_us = time_us_64() + (uint64_t)timeout_ms * 1000;
+    if (io.send_command) io.send_command(io.ctx, cmd);
+}
+
+void AsyncHttpClient::on_connected() {
+    is_connected = true;
+    connects++;
+    waiting_already_connected = false;
+    send_command_for(PROMPT, PROMPT_TIMEOUT_MS, "AT+CIPSEND=%d,%d",
+                     link, header_len + (int)slots[current].req.body_len);
+}
+
+bool AsyncHttpClient::retry_on_fresh_link() {
+    // Solo si la conexión era de antes: el servidor pudo cerrarla por
+    // inactividad justo cuando salía la petición
+    is_connected = false;
+    if (!reused || retried || current < 0) return false;
+    retried = true;
+    Log::info(Log::HTTPC, "Conexión cerrada por el servidor, reconectando...\n");
+    begin_attempt();
+    return true;
+}
+
+void AsyncHttpClient::on_at_reply(AtReply reply) {
+    switch (phase) {
+    case CONNECTING:
+        if (reply == AT_OK) {
+            on_connected();
+        } else if (reply == AT_ALREADY_CONNECTED) {
+            waiting_already_connected = true;
+            deadline_us = time_us_64() + ALREADY_CONNECTED_GRACE_MS * 1000;
+        } else if (reply == AT_ERROR) {
+            if (waiting_already_connected) {
+                on_connected();
+            } else {
+                Log::warn(Log::HTTPC, "Error conectando a %s:%d\n", host, port);
+                phase = IDLE;
+                fail();
+            }
+        }
+        break;
+
+    case PROMPT:
+        if (reply == AT_PROMPT) {
+            const Request& req = slots[current].req;
+            TxSegment segs[] = {{header, (size_t)header_len}, {req.body, req.body_len}};
+            phase = SENDING;
+            deadline_us = time_us_64() + SEND_OK_TIMEOUT_MS * 1000;
+            if (io.send_data) io.send_data(io.ctx, segs, 2);
+        } else if (reply == AT_ERROR || reply == AT_LINK_INVALID) {
+            phase = IDLE;
+            if (!retry_on_fresh_link()) fail();
+        }
+        break;
+
+    case SENDING:
+        if (reply == AT_SEND_OK) {
+            requests++;
+            response.reset();
+            phase = RESPONSE;
+            deadline_us = time_us_64() + (uint64_t)cfg::API_RESPONSE_TIMEOUT_MS * 1000;
+        } else if (reply == AT_SEND_FAIL || reply == AT_ERROR) {
+            Log::warn(Log::HTTPC, "Error enviando datos\n");
+            fail();
+            start_close();
+        }
+        break;
+
+    case CLOSING:
+        if (reply == AT_OK || reply == AT_ERROR) {
+            phase = IDLE;
+            is_connected = false;
+            if (current >= 0) begin_attempt();
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void AsyncHttpClient::on_link_data(const uint8_t* data, size_t len) {
+    if (phase != RESPONSE) return;   // respuesta tardía de una petición ya cerrada
+    response.feed(data, len);
+    if (response.done() || response.failed()) complete();
+}
+
+void AsyncHttpClient::on_link_closed() {
+    is_connected = false;
+    if (phase != RESPONSE) return;   // en otras fases el ESP responde ERROR/SEND FAIL
+
+    if (response.on_close()) {
+        complete();
+        return;
+    }
+    phase = IDLE;
+    if (response.headers_done() || !retry_on_fresh_link()) fail();
+}
+
+void AsyncHttpClient::on_reset() {
+    is_connected = false;
+    phase = IDLE;
+    if (current >= 0) fail();
+}
+
+void AsyncHttpClient::complete() {
+    bool keep = response.keep_alive();
+    finish(response.success() ? DONE : FAILED, response.status());
+    if (keep) {
+        phase = IDLE;
+    } else {
+        start_close();
+    }
+}
+
+void AsyncHttpClient::fail() {
+    finish(FAILED, 0);
+}
+
+void AsyncHttpClient::finish(State state, int http_status) {
+    if (current < 0) return;
+    Slot& s = slots[current];
+    s.state = state;
+    s.http_status = http_status;
+    s.latency_us = (uint32_t)(time_us_64() - s.submitted_us);
+
+    if (state != DONE) failures++;
+    last_http_status = http_status;
+    last_latency = s.latency_us;
+    if (s.latency_us > max_latency) max_latency = s.latency_us;
+
+    current = -1;
+    if (phase == RESPONSE) phase = IDLE;
+}
+
+void AsyncHttpClient::start_close() {
+    send_command_for(CLOSING, CLOSE_TIMEOUT_MS, "AT+CIPCLOSE=%d", link);
+}
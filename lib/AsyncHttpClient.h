@@ -0,0 +1,150 @@
+#ifndef ASYNC_HTTP_CLIENT_H_
+#define ASYNC_HTTP_CLIENT_H_
+
+#include "pico/stdlib.h"
+#include <cstddef>
+#include <cstdint>
+#include "UartDmaTx.h"
+#include "HttpResponseParser.h"
+
+// Cliente HTTP asíncrono sobre un enlace CIPMUX del ESP8266.
+//
+// submit() encola una petición y devuelve un handle al instante; la máquina
+// de estados (CIPSTART -> CIPSEND -> datos -> respuesta) avanza con poll() y
+// con las respuestas del ESP que le pasa quien lee el UART (on_at_reply,
+// on_link_data, on_link_closed). Ninguna llamada espera al ESP.
+//
+// La conexión se mantiene abierta (keep-alive) entre peticiones al mismo
+// host; si el servidor la cerró antes de responder, se reabre y la petición
+// se reintenta una vez.
+class AsyncHttpClient {
+public:
+    struct Request {
+        const char* host;
+        int port;
+        const char* path;
+        const char* content_type;
+        const void* body;       // debe seguir vivo hasta que la petición termine
+        size_t body_len;
+    };
+
+    using Handle = int32_t;
+    static const Handle INVALID_HANDLE = -1;
+
+    enum State : uint8_t { QUEUED, IN_FLIGHT, DONE, FAILED, UNKNOWN };
+
+    struct Result {
+        State state;
+        int http_status;        // 0 si no hubo respuesta
+        uint32_t latency_us;    // de submit() al final
+    };
+
+    // Respuestas del ESP a los comandos del cliente
+    enum AtReply : uint8_t {
+        AT_OK, AT_ERROR, AT_ALREADY_CONNECTED, AT_PROMPT,
+        AT_SEND_OK, AT_SEND_FAIL, AT_LINK_INVALID,
+    };
+
+    // E/S hacia el ESP8266; la aporta el dueño del UART
+    struct Io {
+        void* ctx;
+        void (*send_command)(void* ctx, const char* cmd);
+        void (*send_data)(void* ctx, const TxSegment* segs, int count);
+    };
+
+    static const int MAX_REQUESTS = 4;
+
+    explicit AsyncHttpClient(int link_id);
+    void set_io(const Io& io) { this->io = io; }
+
+    // ===== API =====
+    // INVALID_HANDLE si no queda hueco en la cola
+    Handle submit(const Request& req);
+    // Estado de la petición. DONE solo con respuesta 2xx.
+    Result result(Handle h) const;
+    // Libera el hueco de una petición terminada (o la cancela si aún no salió)
+    void release(Handle h);
+
+    // Avanza plazos y arranca la siguiente petición de la cola
+    void poll();
+
+    // ===== Lado del lector del UART =====
+    void on_at_reply(AtReply reply);
+    void on_link_data(const uint8_t* data, size_t len);
+    void on_link_closed();
+    void on_reset();            // el ESP se reinició ("ready")
+
+    // Hay un comando AT del cliente esperando respuesta
+    bool at_outstanding() const { return phase != IDLE && phase != RESPONSE; }
+    // No hay nada del cliente en vuelo en el UART
+    bool idle() const { return phase == IDLE; }
+    int  link_id() const { return link; }
+
+    // Estadísticas
+    bool     connected() const { return is_connected; }
+    uint32_t connect_count() const { return connects; }
+    uint32_t request_count() const { return requests; }
+    uint32_t failure_count() const { return failures; }
+    int      last_status() const { return last_http_status; }
+    uint32_t last_latency_us() const { return last_latency; }
+    uint32_t max_latency_us() const { return max_latency; }
+    int      pending() const;
+
+private:
+    enum Phase : uint8_t { IDLE, CONNECTING, PROMPT, SENDING, RESPONSE, CLOSING };
+
+    struct Slot {
+        Request req;
+        State state;
+        bool used;
+        uint16_t gen;
+        uint32_t seq;
+        uint64_t submitted_us;
+        uint32_t latency_us;
+        int http_status;
+    };
+
+    Slot* slot_for(Handle h);
+    const Slot* slot_for(Handle h) const;
+
+    void start(int slot);
+    void begin_attempt();
+    void send_command_for(Phase next, uint32_t timeout_ms, const char* fmt, ...);
+    void on_connected();
+    bool retry_on_fresh_link();
+    void complete();
+    void fail();
+    void finish(State state, int http_status);
+    void start_close();
+
+    Io io;
+    int link;
+
+    Slot slots[MAX_REQUESTS];
+    uint32_t next_seq;
+    int current;                // hueco en vuelo, -1 si ninguno
+
+    Phase phase;
+    uint64_t deadline_us;
+    bool waiting_already_connected;
+
+    // Conexión
+    bool is_connected;
+    char host[64];
+    int port;
+    bool reused;                // la petición en curso usa una conexión previa
+    bool retried;
+
+    char header[256];
+    int header_len;
+    HttpResponseParser response;
+
+    uint32_t connects;
+    uint32_t requests;
+    uint32_t failures;
+    int last_http_status;
+    uint32_t last_latency;
+    uint32_t max_latency;
+};
+
+#endif // ASYNC_HTTP_CLIENT_H_
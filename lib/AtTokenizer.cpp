@@ -0,0 +1,145 @@
+#include "AtTokenizer.h"
+#include <cctype>
+#include <cstring>
+
+AtTokenizer::AtTokenizer()
+    : handlers{nullptr, nullptr, nullptr}, truncated(0) {
+    reset();
+}
+
+void AtTokenizer::reset() {
+    line_len = 0;
+    line_overflow = false;
+    skip_space = false;
+    payload_link = -1;
+    payload_left = 0;
+}
+
+void AtTokenizer::emit(Kind kind, int link, int len) {
+    if (!handlers.on_event) return;
+    Event ev = { kind, link, len, line, line_len };
+    handlers.on_event(handlers.ctx, ev);
+}
+
+void AtTokenizer::feed(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        // Carga de una trama +IPD: se entrega en bloque, sin mirar dentro
+        if (payload_left > 0) {
+            size_t n = len - i;
+            if (n > (size_t)payload_left) n = (size_t)payload_left;
+            if (handlers.on_ipd_data) handlers.on_ipd_data(handlers.ctx, payload_link, data + i, n);
+            payload_left -= (int)n;
+            i += n;
+            if (payload_left == 0) {
+                line_len = 0;
+                emit(IPD_END, payload_link);
+            }
+            continue;
+        }
+
+        char c = (char)data[i++];
+
+        if (skip_space) {
+            skip_space = false;
+            if (c == ' ') continue;
+        }
+
+        if (c == '\n') {
+            end_line();
+            continue;
+        }
+
+        if (line_len < sizeof(line) - 1) {
+            line[line_len++] = c;
+        } else {
+            line_overflow = true;
+        }
+
+        // Prompt de CIPSEND: '>' al principio de línea, sin salto detrás
+        if (line_len == 1 && c == '>') {
+            line_len = 0;
+            skip_space = true;
+            emit(PROMPT);
+            continue;
+        }
+
+        if (c == ':' && line_len > 5 && line[0] == '+' && try_ipd_header()) continue;
+    }
+}
+
+// "+IPD,id,len:" (CIPMUX=1) o "+IPD,len:" (CIPMUX=0)
+bool AtTokenizer::try_ipd_header() {
+    if (strncmp(line, "+IPD,", 5) != 0) return false;
+
+    int nums[2] = {0, 0};
+    int count = 0;
+    bool digits = false;
+    for (size_t k = 5; k < line_len - 1; k++) {
+        char d = line[k];
+        if (d == ',' && digits && count == 0) {
+            count = 1;
+            digits = false;
+        } else if (isdigit((unsigned char)d)) {
+            nums[count] = nums[count] * 10 + (d - '0');
+            digits = true;
+        } else {
+            return false;
+        }
+    }
+    if (!digits) return false;
+
+    int link = count == 1 ? nums[0] : -1;
+    int len = count == 1 ? nums[1] : nums[0];
+    line[line_len - 1] = '\0';
+    line_len--;
+    emit(IPD, link, len);
+
+    line_len = 0;
+    payload_link = link;
+    payload_left = len;
+    if (len == 0) emit(IPD_END, link);
+    return true;
+}
+
+static bool line_is(const char* line, size_t len, const char* s) {
+    size_t n = strlen(s);
+    return len == n && memcmp(line, s, n) == 0;
+}
+
+void AtTokenizer::end_line() {
+    if (line_len > 0 && line[line_len - 1] == '\r') line_len--;
+    line[line_len] = '\0';
+    if (line_overflow) truncated++;
+    line_overflow = false;
+
+    if (line_len == 0) return;
+
+    const char* l = line;
+    size_t n = line_len;
+
+    // "n,CONNECT", "n,CLOSED", "n,CONNECT FAIL"
+    if (n >= 3 && isdigit((unsigned char)l[0]) && l[1] == ',') {
+        int link = l[0] - '0';
+        if (line_is(l + 2, n - 2, "CONNECT"))      { emit(LINK_CONNECT, link); line_len = 0; return; }
+        if (line_is(l + 2, n - 2, "CLOSED"))       { emit(LINK_CLOSED, link); line_len = 0; return; }
+        if (line_is(l + 2, n - 2, "CONNECT FAIL")) { emit(LINK_CONNECT_FAIL, link); line_len = 0; return; }
+    }
+
+    static const struct { const char* text; Kind kind; } kLines[] = {
+        {"OK", OK}, {"ERROR", ERROR}, {"FAIL", FAIL},
+        {"SEND OK", SEND_OK}, {"SEND FAIL", SEND_FAIL},
+        {"ALREADY CONNECTED", ALREADY_CONNECTED}, {"link is not valid", LINK_INVALID},
+        {"no change", NO_CHANGE}, {"ready", READY},
+        {"WIFI DISCONNECT", WIFI_DISCONNECT}, {"WIFI CONNECTED", WIFI_CONNECTED},
+        {"WIFI GOT IP", WIFI_GOT_IP}, {"CLOSED", LINK_CLOSED}, {"CONNECT", LINK_CONNECT},
+    };
+    Kind kind = LINE;
+    for (const auto& e : kLines) {
+        if (line_is(l, n, e.text)) { kind = e.kind; break; }
+    }
+    if (kind == LINE && n > 5 && memcmp(l, "busy ", 5) == 0) kind = BUSY;
+
+    emit(kind);
+    line_len = 0;
+}
@@ -0,0 +1,73 @@
+#ifndef AT_TOKENIZER_H_
+#define AT_TOKENIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Tokenizador en streaming de la salida del firmware AT del ESP8266.
+//
+// Recibe los bytes tal como llegan y los parte en líneas completas, el
+// prompt ">" de CIPSEND y las tramas "+IPD,id,len:" (que no terminan en
+// salto de línea y cuya carga se entrega aparte, sin interpretarla). Cada
+// línea se clasifica: las respuestas a comandos (OK, ERROR, SEND OK...) y
+// los eventos no solicitados (n,CONNECT, n,CLOSED, WIFI DISCONNECT, ready)
+// llegan al mismo manejador, que decide a quién van. Como se compara por
+// líneas enteras, no hay coincidencias parciales que se pierdan.
+class AtTokenizer {
+public:
+    enum Kind : uint8_t {
+        // Respuestas a un comando
+        OK, ERROR, FAIL, SEND_OK, SEND_FAIL, ALREADY_CONNECTED, LINK_INVALID,
+        NO_CHANGE, BUSY, PROMPT,
+        // Eventos no solicitados
+        LINK_CONNECT, LINK_CLOSED, LINK_CONNECT_FAIL,
+        WIFI_DISCONNECT, WIFI_CONNECTED, WIFI_GOT_IP, READY,
+        IPD,            // cabecera de trama: link, len
+        IPD_END,        // se entregó toda la carga de la trama
+        // Cualquier otra línea (+CIFSR:..., STATUS:..., Recv N bytes, eco)
+        LINE,
+    };
+
+    struct Event {
+        Kind kind;
+        int link;           // n de "n,CONNECT"/"n,CLOSED"/+IPD; -1 si no aplica
+        int len;            // longitud de la carga (+IPD)
+        const char* text;   // la línea (sin CRLF); válida solo durante la llamada
+        size_t text_len;
+    };
+
+    struct Handlers {
+        void* ctx;
+        void (*on_event)(void* ctx, const Event& ev);
+        void (*on_ipd_data)(void* ctx, int link, const uint8_t* data, size_t len);
+    };
+
+    AtTokenizer();
+    void set_handlers(const Handlers& h) { handlers = h; }
+
+    void feed(const uint8_t* data, size_t len);
+    void feed(uint8_t byte) { feed(&byte, 1); }
+    void reset();
+
+    // Dentro de la carga de una trama +IPD
+    bool in_payload() const { return payload_left > 0; }
+
+    // Líneas más largas que el buffer (se truncan, pero se clasifican)
+    uint32_t truncated_lines() const { return truncated; }
+
+private:
+    void end_line();
+    bool try_ipd_header();
+    void emit(Kind kind, int link = -1, int len = 0);
+
+    Handlers handlers;
+    char line[128];
+    size_t line_len;
+    bool line_overflow;
+    bool skip_space;        // el ESP manda "> " tras el prompt
+    int payload_link;
+    int payload_left;
+    uint32_t truncated;
+};
+
+#endif // AT_TOKENIZER_H_
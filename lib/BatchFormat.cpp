@@ -0,0 +1,72 @@
+#include "BatchFormat.h"
+#include <cstring>
+
+namespace batch {
+
+void write_header(const Header& h, uint8_t* out) {
+    out[0] = MAGIC0;
+    out[1] = MAGIC1;
+    out[2] = h.version;
+    out[3] = h.kind;
+    out[4] = h.flags;
+    out[5] = h.channels;
+    memset(out + 6, 0, DEVICE_ID_LEN);
+    memcpy(out + 6, h.device_id, strnlen(h.device_id, DEVICE_ID_LEN));
+    put_le64(out + 22, h.start_us);
+    put_le16(out + 30, h.sample_rate_hz);
+    put_le16(out + 32, h.counts_per_g);
+    put_le32(out + 34, h.sample_count);
+    put_le32(out + 38, h.event_id);
+    put_le32(out + 42, h.first_index);
+    put_le32(out + 46, h.total_count);
+    put_le32(out + 50, h.trigger_index);
+    put_le32(out + 54, h.sta_lta_ratio_q8);
+}
+
+Encoder::Encoder() : buf(nullptr), cap(0), len(0), samples(0), total(0), prev{0, 0, 0} {}
+
+bool Encoder::begin(uint8_t* buffer, size_t capacity, const Header& header) {
+    buf = nullptr;
+    if (!buffer || capacity < HEADER_SIZE) return false;
+
+    buf = buffer;
+    cap = capacity;
+    samples = 0;
+    total = header.total_count;
+    prev[0] = prev[1] = prev[2] = 0;
+    write_header(header, buf);
+    len = HEADER_SIZE;
+    return true;
+}
+
+void Encoder::put_varint(uint32_t v) {
+    while (v >= 0x80) {
+        buf[len++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    buf[len++] = (uint8_t)v;
+}
+
+bool Encoder::add(int16_t x, int16_t y, int16_t z) {
+    if (!has_room()) return false;
+
+    const int16_t v[CHANNELS] = { x, y, z };
+    for (int c = 0; c < CHANNELS; c++) {
+        put_varint(zigzag_encode((int32_t)v[c] - prev[c]));
+        prev[c] = v[c];
+    }
+    samples++;
+    return true;
+}
+
+size_t Encoder::finish() {
+    if (!buf) return 0;
+    put_le32(buf + 34, samples);
+    if (total == 0) put_le32(buf + 46, samples);
+
+    size_t n = len;
+    buf = nullptr;
+    return n;
+}
+
+} // namespace batch
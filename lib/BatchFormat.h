@@ -0,0 +1,122 @@
+#ifndef BATCH_FORMAT_H_
+#define BATCH_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Formato binario de lotes de muestras (versión 1).
+//
+// Un lote es una cabecera fija de HEADER_SIZE bytes, little-endian, seguida
+// de las muestras. Cada muestra lleva los tres ejes como diferencia con la
+// muestra anterior del mismo eje (la primera, con 0), en zigzag + varint:
+// con ruido de fondo casi todas las diferencias ocupan un byte por eje.
+// Cada lote se decodifica solo, sin estado de lotes anteriores.
+//
+// Este fichero no depende del SDK ni de Config.h: lo comparten el firmware
+// (codificador) y el decodificador de host (tools/batch_decoder).
+//
+//   off  tam  campo
+//     0    2  magic 'S','B'
+//     2    1  versión (VERSION)
+//     3    1  tipo (Kind)
+//     4    1  flags (Flags)
+//     5    1  canales (CHANNELS)
+//     6   16  device_id, relleno con NUL
+//    22    8  start_us: instante de la muestra 0 del registro
+//    30    2  sample_rate_hz
+//    32    2  counts_per_g (escala de las muestras)
+//    34    4  sample_count: muestras en este lote
+//    38    4  event_id (0 en datos continuos)
+//    42    4  first_index: índice de la primera muestra dentro del registro
+//    46    4  total_count: muestras del registro completo
+//    50    4  trigger_index: muestra del disparo dentro del registro
+//    54    4  sta_lta_ratio_q8
+//    58       muestras
+namespace batch {
+
+    inline constexpr uint8_t  MAGIC0   = 'S';
+    inline constexpr uint8_t  MAGIC1   = 'B';
+    inline constexpr uint8_t  VERSION  = 1;
+    inline constexpr uint8_t  CHANNELS = 3;
+    inline constexpr size_t   DEVICE_ID_LEN = 16;
+    inline constexpr size_t   HEADER_SIZE   = 58;
+
+    // Peor caso por muestra: diferencia de 17 bits en zigzag = 3 bytes por eje
+    inline constexpr size_t   MAX_SAMPLE_BYTES = 3 * CHANNELS;
+
+    inline constexpr const char* CONTENT_TYPE = "application/octet-stream";
+
+    enum Kind : uint8_t {
+        KIND_CONTINUOUS = 0,   // flujo continuo (aceleración filtrada)
+        KIND_WAVEFORM   = 1,   // forma de onda de un evento (sin filtrar)
+    };
+
+    enum Flags : uint8_t {
+        FLAG_FILTERED  = 1 << 0,   // muestras tras el filtro pasa banda
+        FLAG_TRUNCATED = 1 << 1,   // el registro llegó a su longitud máxima
+    };
+
+    struct Header {
+        uint8_t  version;
+        uint8_t  kind;
+        uint8_t  flags;
+        uint8_t  channels;
+        char     device_id[DEVICE_ID_LEN + 1];
+        uint64_t start_us;
+        uint16_t sample_rate_hz;
+        uint16_t counts_per_g;
+        uint32_t sample_count;
+        uint32_t event_id;
+        uint32_t first_index;
+        uint32_t total_count;
+        uint32_t trigger_index;
+        uint32_t sta_lta_ratio_q8;
+    };
+
+    // ===== Primitivas compartidas =====
+    inline uint32_t zigzag_encode(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+    inline int32_t  zigzag_decode(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+    inline void put_le16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+    inline void put_le32(uint8_t* p, uint32_t v) { put_le16(p, (uint16_t)v); put_le16(p + 2, (uint16_t)(v >> 16)); }
+    inline void put_le64(uint8_t* p, uint64_t v) { put_le32(p, (uint32_t)v); put_le32(p + 4, (uint32_t)(v >> 32)); }
+    inline uint16_t get_le16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+    inline uint32_t get_le32(const uint8_t* p) { return get_le16(p) | ((uint32_t)get_le16(p + 2) << 16); }
+    inline uint64_t get_le64(const uint8_t* p) { return get_le32(p) | ((uint64_t)get_le32(p + 4) << 32); }
+
+    // Serializa la cabecera en HEADER_SIZE bytes
+    void write_header(const Header& h, uint8_t* out);
+
+    // Codificador incremental sobre un buffer del llamante. No reserva
+    // memoria; add() rechaza la muestra si no cabe el peor caso.
+    class Encoder {
+    public:
+        Encoder();
+
+        // Empieza un lote. Devuelve false si el buffer no cabe ni la cabecera.
+        bool begin(uint8_t* buffer, size_t capacity, const Header& header);
+        bool add(int16_t x, int16_t y, int16_t z);
+
+        // Cierra el lote (escribe sample_count y, si era 0, total_count) y
+        // devuelve su longitud en bytes.
+        size_t finish();
+
+        bool     is_open() const { return buf != nullptr; }
+        bool     has_room() const { return buf && len + MAX_SAMPLE_BYTES <= cap; }
+        uint32_t count() const { return samples; }
+        size_t   size() const { return len; }
+
+    private:
+        void put_varint(uint32_t v);
+
+        uint8_t* buf;
+        size_t   cap;
+        size_t   len;
+        uint32_t samples;
+        uint32_t total;
+        int16_t  prev[CHANNELS];
+    };
+
+} // namespace batch
+
+#endif // BATCH_FORMAT_H_
@@ -0,0 +1,53 @@
+#include "Biquad.h"
+#include "FixedPoint.h"
+
+void Biquad::prime(int32_t x, int32_t y) {
+    x1 = x2 = x << biquad::STATE_SHIFT;
+    y1 = y2 = y << biquad::STATE_SHIFT;
+}
+
+int32_t Biquad::process(int32_t x) {
+    int32_t xq = x << biquad::STATE_SHIFT;
+
+    // Acumulador Q36: coeficientes Q28 × estado Q8
+    int64_t acc = (int64_t)k.b0 * xq
+                + (int64_t)k.b1 * x1
+                + (int64_t)k.b2 * x2
+                - (int64_t)k.a1 * y1
+                - (int64_t)k.a2 * y2;
+    int32_t yq = (int32_t)((acc + (1LL << (biquad::COEF_SHIFT - 1))) >> biquad::COEF_SHIFT);
+
+    x2 = x1; x1 = xq;
+    y2 = y1; y1 = yq;
+    return yq >> biquad::STATE_SHIFT;
+}
+
+AccelFilterBank::AccelFilterBank()
+    : hp{Biquad(biquad::HIGHPASS), Biquad(biquad::HIGHPASS), Biquad(biquad::HIGHPASS)},
+      lp{Biquad(biquad::LOWPASS), Biquad(biquad::LOWPASS), Biquad(biquad::LOWPASS)},
+      primed(false) {
+}
+
+void AccelFilterBank::reset() {
+    for (int i = 0; i < 3; i++) {
+        hp[i].reset();
+        lp[i].reset();
+    }
+    primed = false;
+}
+
+void AccelFilterBank::process(int16_t& ax, int16_t& ay, int16_t& az) {
+    int16_t* axes[3] = {&ax, &ay, &az};
+
+    if (!primed) {
+        // Primera muestra: el paso alto parte en régimen (salida 0)
+        for (int i = 0; i < 3; i++) hp[i].prime(*axes[i], 0);
+        primed = true;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        int32_t v = hp[i].process(*axes[i]);
+        if (cfg::FILTER_BANDPASS) v = lp[i].process(v);
+        *axes[i] = fx::clamp_i16(v);
+    }
+}
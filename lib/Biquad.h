@@ -0,0 +1,116 @@
+#ifndef BIQUAD_H_
+#define BIQUAD_H_
+
+#include <cstdint>
+#include "../Config.h"
+
+// Filtros biquad en punto fijo para el flujo de muestras.
+//
+// Los coeficientes se calculan en tiempo de compilación (fórmulas RBJ) para
+// cfg::SAMPLE_RATE_HZ y se guardan en Q28; el estado guarda 8 bits de
+// fracción para que el paso alto de baja frecuencia no se quede en ciclos
+// límite. En tiempo de ejecución solo hay productos enteros.
+namespace biquad {
+
+    inline constexpr int COEF_SHIFT  = 28;
+    inline constexpr int STATE_SHIFT = 8;
+
+    struct Coeffs {
+        int32_t b0, b1, b2, a1, a2;  // Q28, normalizados por a0
+    };
+
+    // --- trigonometría constexpr (solo para el diseño) ---
+    constexpr double kPi = 3.14159265358979323846;
+
+    constexpr double cx_sin(double x) {
+        // Serie de Taylor; x está en [0, pi] para frecuencias < fs/2
+        double term = x, sum = x;
+        for (int n = 1; n < 12; n++) {
+            term *= -x * x / ((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+    constexpr double cx_cos(double x) {
+        double term = 1.0, sum = 1.0;
+        for (int n = 1; n < 12; n++) {
+            term *= -x * x / ((2 * n - 1) * (2 * n));
+            sum += term;
+        }
+        return sum;
+    }
+    constexpr int32_t to_q28(double v) {
+        return (int32_t)(v * (double)(1 << COEF_SHIFT) + (v >= 0 ? 0.5 : -0.5));
+    }
+
+    // Butterworth de 2º orden (Q = 1/sqrt(2))
+    constexpr Coeffs highpass(double fc, double fs) {
+        double w0 = 2.0 * kPi * fc / fs;
+        double alpha = cx_sin(w0) / (2.0 * 0.70710678118654752);
+        double c = cx_cos(w0);
+        double a0 = 1.0 + alpha;
+        return Coeffs{
+            to_q28((1.0 + c) / 2.0 / a0),
+            to_q28(-(1.0 + c) / a0),
+            to_q28((1.0 + c) / 2.0 / a0),
+            to_q28(-2.0 * c / a0),
+            to_q28((1.0 - alpha) / a0),
+        };
+    }
+    constexpr Coeffs lowpass(double fc, double fs) {
+        double w0 = 2.0 * kPi * fc / fs;
+        double alpha = cx_sin(w0) / (2.0 * 0.70710678118654752);
+        double c = cx_cos(w0);
+        double a0 = 1.0 + alpha;
+        return Coeffs{
+            to_q28((1.0 - c) / 2.0 / a0),
+            to_q28((1.0 - c) / a0),
+            to_q28((1.0 - c) / 2.0 / a0),
+            to_q28(-2.0 * c / a0),
+            to_q28((1.0 - alpha) / a0),
+        };
+    }
+
+    // Coeficientes de la configuración actual
+    inline constexpr Coeffs HIGHPASS = highpass(cfg::FILTER_HIGHPASS_HZ, cfg::SAMPLE_RATE_HZ);
+    inline constexpr Coeffs LOWPASS  = lowpass(cfg::FILTER_LOWPASS_HZ, cfg::SAMPLE_RATE_HZ);
+
+} // namespace biquad
+
+// Una sección biquad (forma directa I) en punto fijo.
+class Biquad {
+public:
+    explicit Biquad(const biquad::Coeffs& c) : k(c) { reset(); }
+
+    // Inicializar el estado como si la entrada llevara tiempo en x
+    // (evita el escalón inicial del paso alto).
+    void prime(int32_t x, int32_t y);
+
+    // Filtrar una muestra (cuentas) y devolver la salida (cuentas).
+    int32_t process(int32_t x);
+
+    void reset() { x1 = x2 = y1 = y2 = 0; }
+
+private:
+    biquad::Coeffs k;
+    int32_t x1, x2, y1, y2;  // Q8
+};
+
+// Cascada paso alto (+ paso bajo opcional) para los tres ejes del
+// acelerómetro: quita gravedad/deriva y limita la banda sísmica.
+class AccelFilterBank {
+public:
+    AccelFilterBank();
+
+    // Filtra en sitio los tres ejes (cuentas).
+    void process(int16_t& ax, int16_t& ay, int16_t& az);
+
+    void reset();
+
+private:
+    Biquad hp[3];
+    Biquad lp[3];
+    bool primed;
+};
+
+#endif // BIQUAD_H_
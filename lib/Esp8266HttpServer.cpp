@@ -1,19 +1,22 @@
 #include "lib/Esp8266HttpServer.h"
 #include <cstdio>
 #include <cstring>
-#include <cctype>
 #include <string_view>
 #include <cmath>
 #include "../web_page.hpp"
-
-// --- Helpers URL ---
-static inline int hexval(int c){ if(c>='0'&&c<='9') return c-'0'; if(c>='A'&&c<='F') return 10+c-'A'; if(c>='a'&&c<='f') return 10+c-'a'; return -1; }
-static void url_decode_inplace(char* s){ char* w=s; for(char* r=s; *r; ){ if(*r=='%'){ int h1=hexval(*(r+1)), h2=hexval(*(r+2)); if(h1>=0&&h2>=0){ *w++=(char)((h1<<4)|h2); r+=3; } else { *w++=*r++; } } else { *w++= (*r=='+') ? ' ' : *r; r++; } } *w='\0'; }
+#include "web_assets.hpp"   // generado en la compilación por tools/gen_web_assets.py
 
 using namespace cfg;
 
+using Tok = AtTokenizer;
+
 Esp8266HttpServer::Esp8266HttpServer() : sensor_ok(false) {
     memset(&current_sensor_data, 0, sizeof(current_sensor_data));
+    client_.set_io(AsyncHttpClient::Io{this, &esp_send_command, &esp_send_data});
+    for (int i = 0; i < MAX_LINKS; i++) {
+        conns_[i].setup(i, HttpConnection::Io{this, &esp_send_command, &esp_send_data});
+    }
+    at_.set_handlers(AtTokenizer::Handlers{this, &on_at_event, &on_ipd_data});
 }
 
 void Esp8266HttpServer::set_sensor_data(const SensorData& data, bool ok) {
@@ -22,15 +25,24 @@ void Esp8266HttpServer::set_sensor_data(const SensorData& data, bool ok) {
 }
 
 bool Esp8266HttpServer::begin() {
+    rx_.begin(UART());
+    tx_.begin(UART());
 
     printf("[UART] Probando enlace a %u...\n", (unsigned)UART_BAUD);
     flush_uart_quiet(100);
     bool got_ok = false;
     for (int i = 0; i < 10 && !got_ok; ++i) {
         send_at("AT");
-        got_ok = wait_for("OK\r\n", 300);
+        got_ok = wait_for(Tok::OK, 300);
         sleep_ms(200);
     }
+    // Si solo se reinició el Pico, el ESP sigue a la velocidad negociada
+    const bool flow = UART_CTS_PIN >= 0 && UART_RTS_PIN >= 0;
+    for (uint32_t baud : UART_FAST_BAUDS) {
+        if (got_ok) break;
+        printf("[UART] Probando si el ESP sigue a %lu...\n", (unsigned long)baud);
+        got_ok = recover_boot_baud(baud, flow);
+    }
     if (!got_ok) {
         printf("[UART] ❌ Sin OK a %u. Revisa GP4→RX, GP5←TX, EN/RST altos y GND común.\n",
                (unsigned)UART_BAUD);
@@ -38,16 +50,17 @@ bool Esp8266HttpServer::begin() {
     }
     printf("[UART] ✅ OK.\n");
 
-    if (AT_DISABLE_ECHO) { send_at("ATE0"); wait_for("OK\r\n", 500); }
-    send_at("AT+CWMODE=1"); wait_for("OK\r\n", 500);
+    if (AT_DISABLE_ECHO) { send_at("ATE0"); wait_for(Tok::OK, 500); }
+    negotiate_baud();
+    send_at("AT+CWMODE=1"); wait_for(Tok::OK, 500);
 
     printf("\n[WiFi] Conectando a \"%s\" (timeout: %d ms)...\n",
            WIFI_SSID, WIFI_JOIN_TIMEOUT_MS);
     char cmd[128];
     std::snprintf(cmd, sizeof(cmd), "AT+CWJAP=\"%s\",\"%s\"", WIFI_SSID, WIFI_PASS);
     send_at(cmd);
-    const char* toks[] = {"OK\r\n", "FAIL\r\n", "ERROR\r\n"};
-    int r = wait_for_any(toks, 3, WIFI_JOIN_TIMEOUT_MS);
+    const Tok::Kind join[] = {Tok::OK, Tok::FAIL, Tok::ERROR};
+    int r = wait_for_any(join, 3, WIFI_JOIN_TIMEOUT_MS);
     if (r != 0) {
         printf("[WiFi] ❌ CWJAP falló con respuesta: %d (%s)\n", r, 
                r == 1 ? "FAIL" : r == 2 ? "ERROR" : "TIMEOUT");
@@ -55,6 +68,7 @@ bool Esp8266HttpServer::begin() {
         return false;
     }
     printf("[WiFi] ✅ Conectado exitosamente a '%s'\n", WIFI_SSID);
+    wifi_connected_ = true;
 
     // Obtener dirección IP
     printf("[WiFi] Obteniendo dirección IP...\n");
@@ -64,91 +78,323 @@ bool Esp8266HttpServer::begin() {
     return start_server();
 }
 
-[[noreturn]] void Esp8266HttpServer::loop() {
-    printf("[HTTP] Servidor listo y esperando conexiones\n");
-    
-    while (true) {
-        // ===== MANEJO HTTP =====
-        int id = -1, len = 0;
-        int ev = wait_ipd_or_ready(&id, &len, 100); // Timeout más corto para no bloquear sensor
-
-        if (ev == -2) {
-            printf("\n[ESP] Detectado 'ready'. Reconfigurando servidor...\n");
-            if (!start_server()) {
-                printf("[ESP] ❌ No se pudo rearmar el servidor. Entrando a diagnóstico.\n");
-                diag_bridge();
-            }
+void Esp8266HttpServer::poll(uint32_t budget_us) {
+    // Mientras se escucha a UART_BAUD no se envía nada al ESP
+    if (reboot_listen_until_us_ != 0 && poll_reboot_listen(budget_us)) return;
+    if (uart_baud_ != UART_BAUD) watch_framing_errors();
+
+    if (esp_reset_) {
+        esp_reset_ = false;
+        printf("\n[ESP] Detectado 'ready'. Reconfigurando servidor...\n");
+        client_.on_reset();
+        for (int i = 0; i < MAX_LINKS; i++) conns_[i].reset();
+        tx_owner_ = -1;
+        // El ESP arranca siempre a UART_BAUD: hay que volver a subir
+        set_host_baud(UART_BAUD, false);
+        negotiate_baud();
+        if (!start_server()) {
+            printf("[ESP] ❌ No se pudo rearmar el servidor. Entrando a diagnóstico.\n");
+            diag_bridge();
+        }
+        return;
+    }
+
+    int listeners = 0;
+    for (int i = 0; i < MAX_LINKS; i++) {
+        conns_[i].poll();
+        if (conns_[i].streaming()) listeners++;
+    }
+    stream_.set_listeners(listeners);
+    if (tx_owner_ >= 0 && !conns_[tx_owner_].at_outstanding()) tx_owner_ = -1;
+
+    // El UART admite un solo comando en vuelo: responde un enlace del
+    // servidor o avanza el cliente, nunca los dos a la vez
+    if (tx_owner_ < 0 && !client_.at_outstanding()) serve_next();
+    if (tx_owner_ < 0) client_.poll();
+
+    // Las respuestas del ESP hacen avanzar a su dueño desde on_at_event;
+    // mientras un enlace espera "SEND OK" se sigue recibiendo en los demás
+    absolute_time_t dl = make_timeout_time_us(budget_us);
+    while (!esp_reset_ && pump(dl)) {}
+}
+
+void Esp8266HttpServer::serve_next() {
+    // Primero las peticiones nuevas, luego los mensajes del stream
+    for (int k = 0; k < MAX_LINKS; k++) {
+        int i = (next_conn_ + k) % MAX_LINKS;
+        HttpConnection& conn = conns_[i];
+        if (conn.state() != HttpConnection::READY) continue;
+
+        next_conn_ = (i + 1) % MAX_LINKS;
+        {
+            Metrics::Scope timer(Metrics::HTTP_DISPATCH);
+            dispatch(conn);
+        }
+        if (conn.streaming()) stream_seq_[i] = stream_.head();
+        conn.start();
+        if (conn.at_outstanding()) tx_owner_ = i;
+        return;
+    }
+
+    static_assert(SseHub::FRAME_MAX <= HttpConnection::BODY_SIZE, "el mensaje SSE no cabe en la conexión");
+    uint64_t now = time_us_64();
+    for (int k = 0; k < MAX_LINKS; k++) {
+        int i = (next_conn_ + k) % MAX_LINKS;
+        HttpConnection& conn = conns_[i];
+        if (!conn.can_push()) continue;
+
+        // Suscriptor lento: salta a lo más antiguo que quede
+        if (stream_seq_[i] < stream_.oldest()) {
+            stream_skipped_ += stream_.oldest() - stream_seq_[i];
+            stream_seq_[i] = stream_.oldest();
+        }
+        size_t len = 0;
+        const char* msg = stream_.frame(stream_seq_[i], &len);
+        if (msg) {
+            stream_seq_[i]++;
+        } else if (now - conn.last_push_us() >= (uint64_t)SSE_KEEPALIVE_MS * 1000) {
+            // Comentario SSE: mantiene vivo el enlace frente a CIPSTO
+            msg = ":\n\n";
+            len = 3;
+        } else {
             continue;
         }
-        if (ev != 1) continue;
-
-        printf("[HTTP] Nueva conexión ID=%d, %d bytes\n", id, len);
-
-        int to_read = len; if (to_read > REQ_BUFFER_SIZE) to_read = REQ_BUFFER_SIZE;
-        int got = read_bytes(reqbuf_, to_read, 3000);
-        if (got <= 0) continue;
-
-        // Debug: imprimir la petición recibida
-        printf("[HTTP] Petición: ");
-        for(int i = 0; i < got && i < 50; i++) {
-            if (reqbuf_[i] >= 32 && reqbuf_[i] <= 126) {
-                putchar(reqbuf_[i]);
-            } else if (reqbuf_[i] == '\r') {
-                printf("\\r");
-            } else if (reqbuf_[i] == '\n') {
-                printf("\\n");
-            } else {
-                printf("\\x%02X", reqbuf_[i]);
+
+        next_conn_ = (i + 1) % MAX_LINKS;
+        conn.push(msg, len);
+        if (conn.at_outstanding()) tx_owner_ = i;
+        return;
+    }
+}
+
+void Esp8266HttpServer::on_at_event(void* ctx, const AtTokenizer::Event& ev) {
+    Esp8266HttpServer* self = static_cast<Esp8266HttpServer*>(ctx);
+
+    // Respuestas a comandos: a la espera bloqueante, si la hay; si no, al
+    // dueño del comando en vuelo
+    if (ev.kind <= Tok::PROMPT) {
+        self->time_reply(ev.kind);
+        if (self->wait_kinds_ && self->wait_hit_ < 0) {
+            for (int i = 0; i < self->wait_n_; i++) {
+                if (self->wait_kinds_[i] == ev.kind) { self->wait_hit_ = i; return; }
             }
+            return;
         }
-        printf("\n");
-
-        bool get_root = false;
-        bool get_favicon = false;
-        bool get_api_sensor = false;
-        const uint8_t* p_space = nullptr;
-        if (got >= 5 && std::memcmp(reqbuf_, "GET /", 5) == 0) {
-            p_space  = (const uint8_t*)std::memchr(reqbuf_, ' ', got); // space after path
-            if (p_space) {
-                const uint8_t* pb = p_space + 1; // should point to '/'
-                if (pb < reqbuf_ + got && *pb == '/') {
-                    const uint8_t* pe = (const uint8_t*)std::memchr(pb, ' ', got - (pb - reqbuf_));
-                    size_t plen = pe ? (size_t)(pe - pb) : 1;
-                    get_root = (plen == 1); // "/"
-                    if (plen >= 11 && std::memcmp(pb, "/api/sensor", 11) == 0) {
-                        get_api_sensor = true;
-                    }
-                    if (plen >= 12 && std::memcmp(pb, "/favicon.ico", 12) == 0) {
-                        get_favicon = true;
-                    }
-                }
-            }
+        if (self->tx_owner_ >= 0) {
+            HttpConnection& conn = self->conns_[self->tx_owner_];
+            conn.on_at_reply(ev.kind);
+            if (!conn.at_outstanding()) self->tx_owner_ = -1;
+            return;
         }
+        if (!self->client_.at_outstanding()) return;
+        switch (ev.kind) {
+            case Tok::OK:                self->client_.on_at_reply(AsyncHttpClient::AT_OK); break;
+            case Tok::ERROR:             self->client_.on_at_reply(AsyncHttpClient::AT_ERROR); break;
+            case Tok::ALREADY_CONNECTED: self->client_.on_at_reply(AsyncHttpClient::AT_ALREADY_CONNECTED); break;
+            case Tok::PROMPT:            self->client_.on_at_reply(AsyncHttpClient::AT_PROMPT); break;
+            case Tok::SEND_OK:           self->client_.on_at_reply(AsyncHttpClient::AT_SEND_OK); break;
+            case Tok::SEND_FAIL:         self->client_.on_at_reply(AsyncHttpClient::AT_SEND_FAIL); break;
+            case Tok::LINK_INVALID:      self->client_.on_at_reply(AsyncHttpClient::AT_LINK_INVALID); break;
+            default: break;
+        }
+        return;
+    }
 
-        printf("[HTTP] Ruta detectada: %s\n", 
-               get_root ? "GET /" : 
-               get_api_sensor ? "GET /api/sensor" : 
-               get_favicon ? "GET /favicon.ico" : "OTRA");
-
-        if (get_root) {
-            printf("[HTTP] Enviando página web HTML\n");
-            send_http_200(id);
-        } else if (get_api_sensor) {
-            printf("[HTTP] Enviando datos JSON del sensor\n");
-            send_api_sensor_json(id);
-        } else if (get_favicon) {
-            const char hdr[] =
-                "HTTP/1.1 204 No Content\r\n"
-                "Connection: close\r\n\r\n";
-            char cmd[40]; std::snprintf(cmd,sizeof(cmd),"AT+CIPSEND=%d,%d", id, (int)sizeof(hdr)-1);
-            send_at(cmd);
-            if (wait_for(">", 1000)) { uart_send_raw(hdr); wait_for("SEND OK\r\n", 1500); }
-            std::snprintf(cmd,sizeof(cmd),"AT+CIPCLOSE=%d",id); send_at(cmd);
-        } else {
-            printf("[HTTP] Enviando 404 Not Found\n");
-            send_http_404(id);
+    bool server_link = ev.link >= 0 && ev.link < MAX_LINKS;
+    switch (ev.kind) {
+        case Tok::READY:
+            // Se rearma en poll(), fuera de cualquier espera en curso
+            self->esp_reset_ = true;
+            self->wifi_connected_ = false;
+            break;
+        case Tok::LINK_CONNECT:
+            if (server_link) self->conns_[ev.link].on_open();
+            break;
+        case Tok::LINK_CLOSED:
+            if (ev.link == self->client_.link_id()) self->client_.on_link_closed();
+            else if (server_link) self->conns_[ev.link].on_closed();
+            break;
+        case Tok::WIFI_DISCONNECT:
+            printf("[WiFi] ⚠️ Desconectado del AP\n");
+            self->wifi_connected_ = false;
+            self->client_.on_reset();
+            break;
+        case Tok::WIFI_GOT_IP:
+            self->wifi_connected_ = true;
+            break;
+        default:
+            break;
+    }
+}
+
+void Esp8266HttpServer::on_ipd_data(void* ctx, int link, const uint8_t* data, size_t len) {
+    Esp8266HttpServer* self = static_cast<Esp8266HttpServer*>(ctx);
+    if (link == self->client_.link_id()) {
+        self->client_.on_link_data(data, len);
+    } else if (link >= 0 && link < MAX_LINKS) {
+        // Cada enlace junta su petición aunque llegue en varias tramas
+        self->conns_[link].on_data(data, len);
+    } else {
+        self->stray_frames_++;
+    }
+}
+
+uint32_t Esp8266HttpServer::dropped_requests() const {
+    uint32_t n = stray_frames_;
+    for (int i = 0; i < MAX_LINKS; i++) n += conns_[i].dropped();
+    return n;
+}
+
+bool Esp8266HttpServer::link_idle() const {
+    if (tx_owner_ >= 0 || !client_.idle() || rx_.available() > 0) return false;
+    for (int i = 0; i < MAX_LINKS; i++) {
+        HttpConnection::State st = conns_[i].state();
+        if (st == HttpConnection::RECEIVING || st == HttpConnection::READY ||
+            st == HttpConnection::RESPONDING || conns_[i].at_outstanding()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Esp8266HttpServer::dispatch(HttpConnection& conn) {
+    using http::method_bit;
+    static constexpr http::Route<RouteHandler> kRouteList[] = {
+        {method_bit(HttpRequest::GET), "/",            &Esp8266HttpServer::route_index},
+        {method_bit(HttpRequest::GET), "/api/sensor",  &Esp8266HttpServer::route_api_sensor},
+        {method_bit(HttpRequest::GET), "/api/stream",  &Esp8266HttpServer::route_api_stream},
+        {method_bit(HttpRequest::GET), "/api/metrics", &Esp8266HttpServer::route_api_metrics},
+        {method_bit(HttpRequest::GET), "/favicon.ico", &Esp8266HttpServer::route_favicon},
+    };
+    static constexpr auto kRoutes = http::make_route_table(kRouteList);
+    static_assert(kRoutes.valid(), "rutas sin hash perfecto");
+
+    Metrics::count(Metrics::HTTP_REQUESTS);
+    HttpRequest req;
+    if (!req.parse(conn.request(), (size_t)conn.request_len())) {
+        Log::warn(Log::HTTP, "Enlace %d: petición mal formada\n", conn.link_id());
+        respond_error(conn, "400 Bad Request", nullptr);
+        return;
+    }
+
+    if (req.method == HttpRequest::UNKNOWN) {
+        respond_error(conn, "501 Not Implemented", nullptr);
+        return;
+    }
+
+    // La ruta se compara decodificada (%xx); sin '%' no hace falta copiarla
+    std::string_view path = req.path;
+    char decoded[64];
+    if (path.find('%') != std::string_view::npos) {
+        if (path.size() >= sizeof(decoded)) {
+            respond_error(conn, "404 Not Found", nullptr);
+            return;
+        }
+        std::memcpy(decoded, path.data(), path.size());
+        decoded[path.size()] = '\0';
+        HttpRequest::path_decode_inplace(decoded);
+        path = decoded;
+    }
+
+    // El log guarda punteros: método y ruta salen de las tablas, no del
+    // buffer de la petición
+    const http::Route<RouteHandler>* route = kRoutes.find(path);
+    Log::info(Log::HTTP, "Enlace %d: %s %s (%d bytes%s)\n", conn.link_id(),
+              HttpRequest::method_name(req.method), route ? route->path.data() : "(ruta desconocida)",
+              conn.request_len(), conn.truncated() ? ", truncada" : "");
+    if (!route) {
+        respond_error(conn, "404 Not Found", nullptr);
+        return;
+    }
+    if (!(route->methods & method_bit(req.method))) {
+        char allow[64] = "Allow: ";
+        size_t n = std::strlen(allow);
+        for (int m = 0; m < HttpRequest::UNKNOWN; m++) {
+            if (!(route->methods & method_bit((HttpRequest::Method)m))) continue;
+            n += std::snprintf(allow + n, sizeof(allow) - n, "%s%s", n > 7 ? ", " : "",
+                               HttpRequest::method_name((HttpRequest::Method)m));
         }
+        std::snprintf(allow + n, sizeof(allow) - n, "\r\n");
+        respond_error(conn, "405 Method Not Allowed", allow);
+        return;
+    }
+
+    if (!(this->*route->handler)(conn, req)) {
+        respond_error(conn, "500 Internal Server Error", nullptr);
+    }
+}
+
+void Esp8266HttpServer::respond_error(HttpConnection& conn, const char* status, const char* extra_headers) {
+    Log::info(Log::HTTP, "Enlace %d: %s\n", conn.link_id(), status);
+    int len = std::snprintf(conn.body_buffer(), HttpConnection::BODY_SIZE, "<h1>%s</h1>", status);
+    conn.respond(status, "text/html; charset=utf-8", conn.body_buffer(), (size_t)len, extra_headers);
+}
+
+bool Esp8266HttpServer::route_api_sensor(HttpConnection& conn, const HttpRequest&) {
+    int len = format_sensor_json(conn.body_buffer(), HttpConnection::BODY_SIZE);
+    return conn.respond("200 OK", "application/json; charset=utf-8", conn.body_buffer(), (size_t)len,
+                        "Access-Control-Allow-Origin: *\r\n");
+}
+
+// Stream SSE: muestras decimadas y disparos (ver SseHub)
+bool Esp8266HttpServer::route_api_stream(HttpConnection& conn, const HttpRequest&) {
+    int subscribers = 0;
+    for (int i = 0; i < MAX_LINKS; i++) {
+        if (conns_[i].streaming()) subscribers++;
+    }
+    if (subscribers >= SSE_MAX_SUBSCRIBERS) {
+        Log::warn(Log::HTTP, "Stream lleno (%d suscriptores)\n", subscribers);
+        stream_rejected_++;
+        static const char body[] = "Demasiados suscriptores";
+        return conn.respond("503 Service Unavailable", "text/plain; charset=utf-8", body, sizeof(body) - 1,
+                            "Retry-After: 10\r\n");
+    }
+    Log::info(Log::HTTP, "Nuevo suscriptor del stream en enlace %d\n", conn.link_id());
+    return conn.respond_stream("text/event-stream", "Access-Control-Allow-Origin: *\r\n",
+                               "retry: 3000\n\n");
+}
+
+// Temporizadores y contadores (ver Metrics). El cuerpo va en metrics_body_,
+// que vive hasta que el enlace termina de enviarlo: si otro enlace lo está
+// usando, 503 y se reintenta.
+bool Esp8266HttpServer::route_api_metrics(HttpConnection& conn, const HttpRequest&) {
+    if (metrics_owner_ >= 0 && metrics_owner_ != conn.link_id() &&
+        conns_[metrics_owner_].state() == HttpConnection::RESPONDING) {
+        static const char body[] = "Métricas ocupadas";
+        return conn.respond("503 Service Unavailable", "text/plain; charset=utf-8", body, sizeof(body) - 1,
+                            "Retry-After: 1\r\n");
+    }
+    int len = Metrics::format_json(metrics_body_, sizeof(metrics_body_));
+    if (len < 0) return false;
+    metrics_owner_ = conn.link_id();
+    return conn.respond("200 OK", "application/json; charset=utf-8", metrics_body_, (size_t)len,
+                        "Access-Control-Allow-Origin: *\r\nCache-Control: no-cache\r\n");
+}
+
+bool Esp8266HttpServer::route_favicon(HttpConnection& conn, const HttpRequest&) {
+    return conn.respond("204 No Content", nullptr, nullptr, 0);
+}
+
+// Página principal: gzip desde flash, o 304 si el navegador ya la tiene
+bool Esp8266HttpServer::route_index(HttpConnection& conn, const HttpRequest& req) {
+    if (req.header("If-None-Match") == web::kIndexHtmlEtag) {
+        Log::info(Log::HTTP, "Página sin cambios (304)\n");
+        char hdr[64];
+        std::snprintf(hdr, sizeof(hdr), "ETag: %s\r\n", web::kIndexHtmlEtag);
+        return conn.respond("304 Not Modified", nullptr, nullptr, 0, hdr);
+    }
+
+    char hdr[160];
+    if (req.header("Accept-Encoding").find("gzip") == std::string_view::npos) {
+        std::snprintf(hdr, sizeof(hdr), "Vary: Accept-Encoding\r\n");
+        return conn.respond("200 OK", web::kIndexContentType, web::kIndexHtml, web::kIndexHtmlLen, hdr);
     }
+    std::snprintf(hdr, sizeof(hdr),
+        "Content-Encoding: gzip\r\n"
+        "ETag: %s\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Vary: Accept-Encoding\r\n", web::kIndexHtmlEtag);
+    return conn.respond("200 OK", web::kIndexContentType, web::kIndexHtmlGz, web::kIndexHtmlGzLen, hdr);
 }
 
 [[noreturn]] void Esp8266HttpServer::diag_bridge() {
@@ -159,161 +405,250 @@ bool Esp8266HttpServer::begin() {
             if (ch == '\n') { uart_putc_raw(UART(), '\r'); uart_putc_raw(UART(), '\n'); }
             else uart_putc_raw(UART(), (char)ch);
         }
-        if (uart_is_readable(UART())) putchar(uart_getc(UART()));
+        int rc = rx_.getc();
+        if (rc >= 0) putchar(rc);
     }
 }
 
 // ======== privados ========
 
 void Esp8266HttpServer::uart_send_raw(const char* s){ while(*s) uart_putc_raw(UART(), *s++); }
-void Esp8266HttpServer::send_at(const char* cmd){ uart_send_raw(cmd); uart_putc_raw(UART(), '\r'); uart_putc_raw(UART(), '\n'); }
+void Esp8266HttpServer::send_at(const char* cmd){
+    at_sent_us_ = time_us_32();
+    at_pending_ = true;
+    prompt_pending_ = std::strncmp(cmd, "AT+CIPSEND", 10) == 0;
+    Metrics::count(Metrics::AT_COMMANDS);
+    uart_send_raw(cmd); uart_putc_raw(UART(), '\r'); uart_putc_raw(UART(), '\n');
+}
 
-void Esp8266HttpServer::flush_uart_quiet(uint32_t quiet_ms){
-    absolute_time_t dl = make_timeout_time_ms(quiet_ms);
-    while(!time_reached(dl)){
-        if(uart_is_readable(UART())){
-            int ch = uart_getc(UART());
-            if (LOG_TO_USB) putchar(ch);
-            dl = make_timeout_time_ms(quiet_ms);
-        }
+// AT+CIPSEND responde OK y luego '>': el OK cuenta como ida y vuelta del
+// comando y '>' se mide aparte desde el mismo envío
+void Esp8266HttpServer::time_reply(Tok::Kind kind){
+    uint32_t now = time_us_32();
+    if (kind == Tok::PROMPT) {
+        if (prompt_pending_) Metrics::record(Metrics::CIPSEND_PROMPT, now - at_sent_us_);
+        prompt_pending_ = false;
+        at_pending_ = false;
+    } else if (kind == Tok::SEND_OK || kind == Tok::SEND_FAIL) {
+        if (data_pending_) Metrics::record(Metrics::CIPSEND_DATA, now - data_sent_us_);
+        data_pending_ = false;
+    } else if (at_pending_) {
+        Metrics::record(Metrics::AT_ROUND_TRIP, now - at_sent_us_);
+        at_pending_ = false;
+    }
+    if (kind == Tok::ERROR || kind == Tok::FAIL || kind == Tok::SEND_FAIL) {
+        Metrics::count(Metrics::AT_ERRORS);
     }
 }
 
-int Esp8266HttpServer::wait_for_any(const char* const tokens[], int ntokens, uint32_t timeout_ms){
-    if (ntokens > 8) ntokens = 8;
-    size_t n[8], m[8];
-    for (int i=0;i<ntokens;++i){ n[i]=std::strlen(tokens[i]); m[i]=0; }
-    absolute_time_t dl = make_timeout_time_ms(timeout_ms);
-    while(!time_reached(dl)){
-        if(!uart_is_readable(UART())){ tight_loop_contents(); continue; }
-        int ch = uart_getc(UART());
-        if (LOG_TO_USB) putchar(ch);
-        for(int i=0;i<ntokens;++i){
-            if ((size_t)ch == (size_t)tokens[i][m[i]]) {
-                if(++m[i]==n[i]) return i;
-            } else {
-                m[i] = (ch == tokens[i][0]) ? 1 : 0;
-            }
-        }
+int Esp8266HttpServer::rx_getc(absolute_time_t deadline){
+    int ch = rx_.getc();
+    while (ch < 0) {
+        if (!rx_.wait_for_data(deadline)) return -1;
+        ch = rx_.getc();
     }
-    return -1;
+    echo(ch);
+    return ch;
 }
-bool Esp8266HttpServer::wait_for(const char* tok, uint32_t ms){ const char* t[]={tok}; return wait_for_any(t,1,ms)==0; }
 
-int Esp8266HttpServer::read_bytes(uint8_t* buf, int maxlen, uint32_t timeout_ms){
-    int got = 0;
-    absolute_time_t dl = make_timeout_time_ms(timeout_ms);
-    while(got < maxlen && !time_reached(dl)){
-        if(uart_is_readable(UART())){
-            buf[got++] = (uint8_t)uart_getc(UART());
-            if (LOG_TO_USB) putchar(buf[got-1]);
-            dl = make_timeout_time_ms(timeout_ms);
-        } else tight_loop_contents();
+// Eco del tráfico del ESP por líneas: un registro del log por línea (o por
+// RAW_BYTES), nunca un putchar por byte
+void Esp8266HttpServer::echo(int ch){
+    if (!Log::enabled(Log::ESP, Log::DEBUG)) return;
+    echo_[echo_len_++] = (char)ch;
+    if (ch == '\n' || echo_len_ == sizeof(echo_)) {
+        Log::raw(Log::ESP, Log::DEBUG, echo_, echo_len_);
+        echo_len_ = 0;
     }
-    return got;
 }
 
-int Esp8266HttpServer::wait_ipd_or_ready(int* out_id, int* out_len, uint32_t timeout_ms){
-    static const char tag[] = "+IPD,"; const size_t tag_len = sizeof(tag)-1;
-    const char* tok_ready = "ready\r\n";
-    size_t m_ipd=0, m_ready=0;
-    int id=0,len=0; bool have_id=false, have_len=false;
+bool Esp8266HttpServer::pump(absolute_time_t deadline){
+    int ch = rx_getc(deadline);
+    if (ch < 0) return false;
+    at_.feed((uint8_t)ch);
+    return true;
+}
 
+void Esp8266HttpServer::flush_uart_quiet(uint32_t quiet_ms){
+    absolute_time_t dl = make_timeout_time_ms(quiet_ms);
+    while (pump(dl)) {
+        dl = make_timeout_time_ms(quiet_ms);
+    }
+}
+
+int Esp8266HttpServer::wait_for_any(const AtTokenizer::Kind kinds[], int nkinds, uint32_t timeout_ms){
+    // Lo que no sea la respuesta esperada (tramas +IPD, eventos) se sigue
+    // repartiendo por on_at_event mientras tanto
+    wait_kinds_ = kinds;
+    wait_n_ = nkinds;
+    wait_hit_ = -1;
     absolute_time_t dl = make_timeout_time_ms(timeout_ms);
-    while(!time_reached(dl)){
-        if(!uart_is_readable(UART())){ tight_loop_contents(); continue; }
-        int ch = uart_getc(UART());
-        if (LOG_TO_USB) putchar(ch);
-
-        // ready?
-        if (ch == tok_ready[m_ready]) {
-            if (++m_ready == std::strlen(tok_ready)) return -2;
-        } else {
-            m_ready = (ch == tok_ready[0]) ? 1 : 0;
-        }
+    while (wait_hit_ < 0 && pump(dl)) {}
+    wait_kinds_ = nullptr;
+    return wait_hit_;
+}
+bool Esp8266HttpServer::wait_for(AtTokenizer::Kind kind, uint32_t ms){ return wait_for_any(&kind, 1, ms) == 0; }
+
+// Tiempo que tarda el ESP en decir "ready" tras un reinicio
+static const uint32_t ESP_BOOT_MS = 2000;
 
-        // +IPD,?
-        if (ch == (int)tag[m_ipd]) {
-            if (++m_ipd == tag_len) {
-                // ID
-                while(!time_reached(dl)){
-                    if(!uart_is_readable(UART())){ tight_loop_contents(); continue; }
-                    int c = uart_getc(UART()); if (LOG_TO_USB) putchar(c);
-                    if(c==','){ have_id=true; break; }
-                    if(!std::isdigit(c)) return 0;
-                    id=id*10+(c-'0');
-                }
-                // LEN
-                while(!time_reached(dl)){
-                    if(!uart_is_readable(UART())){ tight_loop_contents(); continue; }
-                    int c = uart_getc(UART()); if (LOG_TO_USB) putchar(c);
-                    if(c==':'){ have_len=true; break; }
-                    if(!std::isdigit(c)) return 0;
-                    len=len*10+(c-'0');
-                }
-                if(have_id && have_len){ *out_id=id; *out_len=len; return 1; }
-                return 0;
+// Tiempo (µs) que tarda en llenarse la FIFO RX de 32 bytes (10 bits por byte)
+static uint32_t fifo_fill_us(uint32_t baud) {
+    return (uint32_t)(32ull * 10u * 1000000u / baud);
+}
+
+void Esp8266HttpServer::negotiate_baud() {
+    const bool flow = UART_CTS_PIN >= 0 && UART_RTS_PIN >= 0;
+    // Un diario de menos de dos sectores no arranca: no escribe en flash
+    const bool journal = JOURNAL_SECTORS >= 2;
+    const Tok::Kind reply[] = {Tok::OK, Tok::ERROR};
+    char cmd[48];
+    for (uint32_t baud : UART_FAST_BAUDS) {
+        if (baud <= uart_baud_) continue;
+        // Sin RTS/CTS la FIFO tiene que aguantar una página programada en flash
+        if (!flow && journal && fifo_fill_us(baud) < UART_FLASH_STALL_US) {
+            printf("[UART] %lu sin RTS/CTS desborda la FIFO al escribir el diario; se omite\n",
+                   (unsigned long)baud);
+            continue;
+        }
+        std::snprintf(cmd, sizeof(cmd), "AT+UART_CUR=%lu,8,1,0,%d", (unsigned long)baud, flow ? 3 : 0);
+        send_at(cmd);
+        // El OK sale aún a la velocidad vieja; el ESP cambia justo después
+        int r = wait_for_any(reply, 2, 500);
+        if (r == 1) {
+            printf("[UART] El ESP no admite %s. Se queda a %lu.\n", cmd, (unsigned long)uart_baud_);
+            break;
+        }
+        if (r == 0) {
+            sleep_ms(5);
+            set_host_baud(baud, flow);
+            if (verify_link()) {
+                printf("[UART] ✅ Enlace a %lu baudios%s\n", (unsigned long)baud,
+                       flow ? " con RTS/CTS" : "");
+                break;
             }
-        } else {
-            m_ipd = (ch==tag[0]) ? 1 : 0;
+        }
+        printf("[UART] ⚠️ %lu no pasa la verificación. Volviendo a %lu...\n",
+               (unsigned long)baud, (unsigned long)UART_BAUD);
+        if (!recover_boot_baud(baud, flow)) {
+            printf("[UART] ❌ El ESP no responde ni a %lu ni a %lu\n",
+                   (unsigned long)baud, (unsigned long)UART_BAUD);
+            break;
         }
     }
-    return 0;
+    // Los errores de trama del cambio no cuentan como reinicio
+    framing_seen_ = rx_.framing_error_count();
 }
 
-void Esp8266HttpServer::send_http_200(int id){
-    char hdr[256];
-    int hlen = std::snprintf(hdr,sizeof(hdr),
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: %s\r\n"
-        "Content-Length: %u\r\n"
-        "Connection: close\r\n\r\n",
-        web::kIndexContentType,(unsigned)web::kIndexHtmlLen);
-    int total = hlen + (int)web::kIndexHtmlLen;
+// Tras un cambio fallido el ESP puede estar a cualquiera de las dos
+// velocidades: primero se prueba UART_BAUD y, si no responde, se le pide
+// volver desde la velocidad probada
+bool Esp8266HttpServer::recover_boot_baud(uint32_t tried, bool flow) {
+    set_host_baud(UART_BAUD, false);
+    if (verify_link()) return true;
 
-    char cmd[40]; std::snprintf(cmd,sizeof(cmd),"AT+CIPSEND=%d,%d", id, total);
+    set_host_baud(tried, flow);
+    char cmd[48];
+    std::snprintf(cmd, sizeof(cmd), "AT+UART_CUR=%lu,8,1,0,0", (unsigned long)UART_BAUD);
     send_at(cmd);
-    if(!wait_for(">",2000)){ std::snprintf(cmd,sizeof(cmd),"AT+CIPCLOSE=%d",id); send_at(cmd); return; }
-    uart_send_raw(hdr); uart_send_raw(web::kIndexHtml);
-    wait_for("SEND OK\r\n",3000);
-    std::snprintf(cmd,sizeof(cmd),"AT+CIPCLOSE=%d",id); send_at(cmd);
-}
-
-void Esp8266HttpServer::send_http_404(int id){
-    static const char body[]="<h1>404 Not Found</h1>";
-    char hdr[200];
-    int hlen = std::snprintf(hdr,sizeof(hdr),
-        "HTTP/1.1 404 Not Found\r\n"
-        "Content-Type: text/html; charset=utf-8\r\n"
-        "Content-Length: %u\r\n"
-        "Connection: close\r\n\r\n",(unsigned)sizeof(body)-1);
-    int total = hlen + (int)sizeof(body)-1;
-
-    char cmd[40]; std::snprintf(cmd,sizeof(cmd),"AT+CIPSEND=%d,%d", id, total);
-    send_at(cmd);
-    if(!wait_for(">",2000)){ std::snprintf(cmd,sizeof(cmd),"AT+CIPCLOSE=%d",id); send_at(cmd); return; }
-    uart_send_raw(hdr); uart_send_raw(body);
-    wait_for("SEND OK\r\n",3000);
-    std::snprintf(cmd,sizeof(cmd),"AT+CIPCLOSE=%d",id); send_at(cmd);
+    wait_for(Tok::OK, 300);     // con el enlace mal puede no llegar entero
+    sleep_ms(5);
+    set_host_baud(UART_BAUD, false);
+    return verify_link();
+}
+
+void Esp8266HttpServer::set_host_baud(uint32_t baud, bool flow) {
+    // Lo pendiente de enviar saldría a la velocidad nueva
+    tx_.wait_done(make_timeout_time_ms(100));
+    uart_tx_wait_blocking(UART());
+    uart_set_baudrate(UART(), baud);
+    uart_set_hw_flow(UART(), flow, flow);
+    uart_baud_ = baud;
+    uart_flow_ = flow;
+}
+
+bool Esp8266HttpServer::verify_link() {
+    // Lo que llegó a medias durante el cambio se descarta y el primer "AT"
+    // solo resincroniza al tokenizador
+    flush_uart_quiet(20);
+    send_at("AT");
+    wait_for(Tok::OK, 200);
+    uint32_t fe = rx_.framing_error_count();
+    for (int i = 0; i < UART_VERIFY_ROUNDS; i++) {
+        send_at("AT");
+        if (!wait_for(Tok::OK, 200)) return false;
+    }
+    // Una respuesta larga prueba también una ráfaga seguida hacia el Pico
+    send_at("AT+GMR");
+    return wait_for(Tok::OK, 500) && rx_.framing_error_count() == fe;
+}
+
+// A velocidad alta, el banner de la ROM y el "ready" de un ESP reiniciado
+// llegan como basura. Un error de trama suelto es ruido; con
+// UART_REBOOT_FRAMING_ERRORS dentro de UART_REBOOT_WINDOW_MS se pasa a
+// escuchar a UART_BAUD durante ESP_BOOT_MS.
+void Esp8266HttpServer::watch_framing_errors() {
+    uint32_t fe = rx_.framing_error_count();
+    if (fe == framing_seen_) return;
+    uint64_t now = time_us_64();
+    if (now - framing_window_us_ > (uint64_t)UART_REBOOT_WINDOW_MS * 1000) {
+        framing_window_us_ = now;
+        framing_base_ = framing_seen_;
+    }
+    framing_seen_ = fe;
+    if (fe - framing_base_ < UART_REBOOT_FRAMING_ERRORS) return;
+
+    printf("\n[UART] %lu errores de trama a %lu. ¿Se ha reiniciado el ESP?\n",
+           (unsigned long)(fe - framing_base_), (unsigned long)uart_baud_);
+    listen_saved_baud_ = uart_baud_;
+    listen_saved_flow_ = uart_flow_;
+    set_host_baud(UART_BAUD, false);
+    reboot_listen_until_us_ = now + (uint64_t)ESP_BOOT_MS * 1000;
+}
+
+// Si aparece "ready", on_at_event marca esp_reset_ y poll() lo rearma todo.
+// Si vence el plazo, era ruido y se vuelve a la velocidad negociada (lo que
+// el ESP enviara entretanto se pierde y lo recupera el plazo del comando en
+// vuelo).
+bool Esp8266HttpServer::poll_reboot_listen(uint32_t budget_us) {
+    absolute_time_t dl = make_timeout_time_us(budget_us);
+    while (!esp_reset_ && pump(dl)) {}
+    if (esp_reset_) {
+        reboot_listen_until_us_ = 0;
+        return false;           // poll() sigue con el rearme
+    }
+    if (time_us_64() < reboot_listen_until_us_) return true;
+
+    reboot_listen_until_us_ = 0;
+    set_host_baud(listen_saved_baud_, listen_saved_flow_);
+    framing_seen_ = rx_.framing_error_count();
+    framing_window_us_ = 0;
+    printf("[UART] Era ruido; se sigue a %lu\n", (unsigned long)uart_baud_);
+    return false;
 }
 
 bool Esp8266HttpServer::start_server(){
     printf("[HTTP] Iniciando servidor HTTP...\n");
+    char cmd_max[40];
     
     send_at("AT+CIPMUX=1");
-    if (!wait_for("OK\r\n", 800)) {
-        const char* tk[]={"no change\r\n"};
-        wait_for_any(tk,1,400);
-    }
+    const Tok::Kind mux[] = {Tok::OK, Tok::NO_CHANGE};
+    wait_for_any(mux, 2, 1200);
     printf("[HTTP] CIPMUX configurado\n");
     
     send_at("AT+CIPSERVER=0");
-    wait_for("OK\r\n", 600); // ignora si no llega
+    wait_for(Tok::OK, 600); // ignora si no llega
+
+    // El enlace de la API queda fuera del servidor (firmware AT >= 1.5;
+    // en versiones anteriores responde ERROR y se ignora)
+    std::snprintf(cmd_max, sizeof(cmd_max), "AT+CIPSERVERMAXCONN=%d", API_LINK_ID);
+    send_at(cmd_max);
+    wait_for(Tok::OK, 600);
 
     char cmd[32];
     std::snprintf(cmd,sizeof(cmd),"AT+CIPSERVER=1,%d", HTTP_PORT);
     send_at(cmd);
-    const char* toks_srv[]={"OK\r\n","no change\r\n"};
+    const Tok::Kind toks_srv[]={Tok::OK, Tok::NO_CHANGE};
     int tr = wait_for_any(toks_srv, 2, 1500);
     if (tr < 0) { 
         printf("[HTTP] ❌ CIPSERVER no arrancó (timeout)\n"); 
@@ -322,7 +657,7 @@ bool Esp8266HttpServer::start_server(){
     printf("[HTTP] CIPSERVER iniciado en puerto %d\n", HTTP_PORT);
 
     std::snprintf(cmd,sizeof(cmd),"AT+CIPSTO=%d", SERVER_IDLE_TIMEOUT_S);
-    send_at(cmd); wait_for("OK\r\n", 800);
+    send_at(cmd); wait_for(Tok::OK, 800);
 
     send_at("AT+CIPSTATUS"); 
     flush_uart_quiet(500);
@@ -330,9 +665,8 @@ bool Esp8266HttpServer::start_server(){
     return true;
 }
 
-void Esp8266HttpServer::send_api_sensor_json(int id) {
-    char json_body[256];
-    int len = std::snprintf(json_body, sizeof(json_body),
+int Esp8266HttpServer::format_sensor_json(char* out, size_t size) const {
+    int len = std::snprintf(out, size,
         "{"
         "\"accel_x\":%.6f,"
         "\"accel_y\":%.6f,"
@@ -344,88 +678,61 @@ void Esp8266HttpServer::send_api_sensor_json(int id) {
         "\"timestamp\":%lu,"
         "\"status\":\"%s\""
         "}",
-        current_sensor_data.accel_x,
-        current_sensor_data.accel_y,
-        current_sensor_data.accel_z,
-        current_sensor_data.gyro_x,
-        current_sensor_data.gyro_y,
-        current_sensor_data.gyro_z,
-        current_sensor_data.magnitude,
+        fx::accel_to_mps2(current_sensor_data.accel_x),
+        fx::accel_to_mps2(current_sensor_data.accel_y),
+        fx::accel_to_mps2(current_sensor_data.accel_z),
+        fx::gyro_to_dps(current_sensor_data.gyro_x),
+        fx::gyro_to_dps(current_sensor_data.gyro_y),
+        fx::gyro_to_dps(current_sensor_data.gyro_z),
+        fx::accel_to_mps2(current_sensor_data.magnitude),
         (unsigned long)current_sensor_data.timestamp,
         sensor_ok ? "online" : "offline"
     );
-    
-    char hdr[160];
-    int hlen = std::snprintf(hdr, sizeof(hdr),
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: application/json; charset=utf-8\r\n"
-        "Content-Length: %d\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "Connection: close\r\n\r\n",
-        len);
-    
-    int total = hlen + len;
-    char cmd[48]; std::snprintf(cmd, sizeof(cmd), "AT+CIPSEND=%d,%d", id, total);
-    send_at(cmd);
-    if (wait_for(">", 2000)) {
-        uart_send_raw(hdr);
-        uart_send_raw(json_body);
-        wait_for("SEND OK\r\n", 3000);
-    }
-    std::snprintf(cmd, sizeof(cmd), "AT+CIPCLOSE=%d", id);
-    send_at(cmd);
+    if (len < 0) return 0;
+    return len < (int)size ? len : (int)size - 1;
 }
 
 bool Esp8266HttpServer::http_post_json(const char* host, int port, const char* path, const char* json_data) {
-    char cmd[128];
-    
-    // Conectar TCP al host de la API
-    std::snprintf(cmd, sizeof(cmd), "AT+CIPSTART=4,\"TCP\",\"%s\",%d", host, port);
-    send_at(cmd);
-    
-    const char* conn_tokens[] = {"OK\r\n", "ALREADY CONNECTED\r\n", "ERROR\r\n"};
-    int conn_result = wait_for_any(conn_tokens, 3, 5000);
-    if (conn_result < 0 || conn_result == 2) {
-        printf("[API] ❌ Error conectando a %s:%d\n", host, port);
+    return http_post(host, port, path, "application/json", json_data, strlen(json_data));
+}
+
+bool Esp8266HttpServer::http_post(const char* host, int port, const char* path,
+                                  const char* content_type, const void* body, size_t body_len) {
+    AsyncHttpClient::Request req = {host, port, path, content_type, body, body_len};
+    AsyncHttpClient::Handle h = client_.submit(req);
+    if (h == AsyncHttpClient::INVALID_HANDLE) {
+        printf("[API] ❌ Cola del cliente HTTP llena\n");
         return false;
     }
-    
-    // Preparar HTTP POST request
-    char http_request[512];
-    int content_length = strlen(json_data);
-    int request_len = std::snprintf(http_request, sizeof(http_request),
-        "POST %s HTTP/1.1\r\n"
-        "Host: %s\r\n"
-        "Content-Type: application/json\r\n"
-        "Content-Length: %d\r\n"
-        "Connection: close\r\n"
-        "\r\n"
-        "%s",
-        path, host, content_length, json_data);
-    
-    // Enviar datos
-    std::snprintf(cmd, sizeof(cmd), "AT+CIPSEND=4,%d", request_len);
-    send_at(cmd);
-    
-    if (wait_for(">", 2000)) {
-        uart_send_raw(http_request);
-        if (wait_for("SEND OK\r\n", 3000)) {
-            printf("[API] ✅ Datos enviados a %s\n", host);
-            
-            // Esperar respuesta
-            flush_uart_quiet(2000);
-            
-            // Cerrar conexión
-            send_at("AT+CIPCLOSE=4");
-            wait_for("OK\r\n", 1000);
-            
-            return true;
-        }
+
+    AsyncHttpClient::Result r = client_.result(h);
+    while (r.state == AsyncHttpClient::QUEUED || r.state == AsyncHttpClient::IN_FLIGHT) {
+        poll(1000);
+        r = client_.result(h);
+    }
+    client_.release(h);
+
+    printf("[API] %s %s%s -> %d (%lu ms)\n", r.state == AsyncHttpClient::DONE ? "✅" : "❌",
+           host, path, r.http_status, (unsigned long)(r.latency_us / 1000));
+    return r.state == AsyncHttpClient::DONE;
+}
+
+void Esp8266HttpServer::esp_send_command(void* ctx, const char* cmd) {
+    static_cast<Esp8266HttpServer*>(ctx)->send_at(cmd);
+}
+
+void Esp8266HttpServer::esp_send_data(void* ctx, const TxSegment* segs, int count) {
+    Esp8266HttpServer* self = static_cast<Esp8266HttpServer*>(ctx);
+    size_t total = 0;
+    for (int i = 0; i < count; ++i) total += segs[i].len;
+    Metrics::count(Metrics::TX_BYTES, (uint32_t)total);
+    self->data_sent_us_ = time_us_32();
+    self->data_pending_ = true;
+    // Por DMA si está libre; "SEND OK" lo recoge poll()
+    if (!self->tx_.send(segs, count)) {
+        for (int i = 0; i < count; ++i)
+            uart_write_blocking(UART(), (const uint8_t*)segs[i].data, segs[i].len);
     }
-    
-    printf("[API] ❌ Error enviando datos\n");
-    send_at("AT+CIPCLOSE=4");
-    return false;
 }
 
 // ===== SIMULACIÓN SENSOR MPU6050 =====
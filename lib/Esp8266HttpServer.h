@@ -8,6 +8,16 @@
 #include "hardware/gpio.h"
 #include "Config.h"
 #include "lib/MPU6050.h"  // Para SensorData
+#include "lib/UartRxRing.h"
+#include "lib/UartDmaTx.h"
+#include "lib/AsyncHttpClient.h"
+#include "lib/AtTokenizer.h"
+#include "lib/HttpConnection.h"
+#include "lib/HttpRequest.h"
+#include "lib/HttpRouter.h"
+#include "lib/SseHub.h"
+#include "lib/Log.h"
+#include "lib/Metrics.h"
 
 class Esp8266HttpServer {
 public:
@@ -19,12 +29,21 @@ public:
     // ... existing methods ...
     Esp8266HttpServer();
 
-    // Inicializa UART, asocia Wi-Fi y levanta CIPSERVER.
-    // Devuelve false si no obtiene "OK" del ESP a 115200.
+    // Inicializa UART, sube la velocidad del enlace (cfg::UART_FAST_BAUDS),
+    // asocia Wi-Fi y levanta CIPSERVER.
+    // Devuelve false si no obtiene "OK" del ESP a cfg::UART_BAUD.
     bool begin();
 
-    // Bucle principal: atiende +IPD y re-arma servidor si detecta "ready".
-    [[noreturn]] void loop();
+    // Paso no bloqueante: lee lo que llegue del ESP durante como mucho
+    // budget_us, avanza las respuestas de cada enlace y el cliente HTTP, y
+    // re-arma el servidor si detecta "ready".
+    void poll(uint32_t budget_us);
+
+    // Contadores del buffer RX (bytes perdidos por desbordamiento)
+    const UartRxRing& rx_ring() const { return rx_; }
+    // Velocidad negociada con el ESP y si va con RTS/CTS
+    uint32_t uart_baud() const { return uart_baud_; }
+    bool uart_flow_control() const { return uart_flow_; }
 
     // Puente USB↔ESP para diagnóstico.
     [[noreturn]] void diag_bridge();
@@ -34,37 +53,156 @@ public:
     bool send_earthquake_data(float accel_x, float accel_y, float accel_z, 
                              float magnitude, bool is_earthquake);
 
-    // Cliente HTTP para API externa
+    // Cliente HTTP asíncrono hacia la API (enlace cfg::API_LINK_ID). Las
+    // peticiones avanzan dentro de poll().
+    AsyncHttpClient& http_client() { return client_; }
+    const AsyncHttpClient& http_client() const { return client_; }
+
+    // Envoltorios bloqueantes sobre http_client(): esperan dando vueltas a
+    // poll(). Devuelven true solo si la respuesta fue 2xx.
     bool http_post_json(const char* host, int port, const char* path, 
                        const char* json_data);
+    bool http_post(const char* host, int port, const char* path,
+                   const char* content_type, const void* body, size_t body_len);
+
+    // Enlaces del servidor (0 .. cfg::API_LINK_ID-1)
+    static const int MAX_LINKS = cfg::API_LINK_ID;
+    const HttpConnection& connection(int link) const { return conns_[link]; }
+    // Tramas descartadas: llegaron con la respuesta del enlace en curso o
+    // en un enlace fuera de rango
+    uint32_t dropped_requests() const;
+
+    // Nada en curso con el ESP: ningún enlace recibiendo o respondiendo, el
+    // cliente HTTP parado y el buffer RX vacío. Solo entonces conviene parar
+    // las interrupciones (borrar flash) sin perder bytes del UART.
+    bool link_idle() const;
+
+    // Stream SSE de /api/stream: los productores publican aquí
+    SseHub& live_stream() { return stream_; }
+    uint32_t stream_skipped() const { return stream_skipped_; }
+    uint32_t stream_rejected() const { return stream_rejected_; }
+
+    // Asociado a la red: true tras CWJAP, false con "WIFI DISCONNECT"
+    bool wifi_connected() const { return wifi_connected_; }
+    const AtTokenizer& at_tokenizer() const { return at_; }
 
 private:
     SensorData current_sensor_data;
     bool sensor_ok = false;
+    uint32_t last_api_send = 0;
+
+    // Enlace del servidor con un comando AT en vuelo (-1 si ninguno). El
+    // UART es uno solo: o responde un enlace o avanza el cliente.
+    int tx_owner_ = -1;
+    int next_conn_ = 0;         // reparto por turnos entre enlaces listos
+    uint32_t stray_frames_ = 0;
+
+    // Cursor de cada suscriptor en stream_
+    uint32_t stream_seq_[MAX_LINKS] = {0};
+    uint32_t stream_skipped_ = 0;   // mensajes perdidos por suscriptores lentos
+    uint32_t stream_rejected_ = 0;  // suscripciones rechazadas por el tope
+
+    // Eventos no solicitados que poll() atiende fuera del tokenizador
+    bool esp_reset_ = false;
+    bool wifi_connected_ = false;
+
+    // Velocidad actual del UART. El ESP la olvida al reiniciarse y entonces
+    // habla a cfg::UART_BAUD: los errores de trama delatan el reinicio.
+    uint32_t uart_baud_ = cfg::UART_BAUD;
+    bool uart_flow_ = false;
+    uint32_t framing_seen_ = 0;
+    uint32_t framing_base_ = 0;         // contador al abrir la ventana de la ráfaga
+    uint64_t framing_window_us_ = 0;
+    // Escucha a UART_BAUD en curso (0 si no): hasta ese instante se espera
+    // el "ready"; después se vuelve a la velocidad guardada
+    uint64_t reboot_listen_until_us_ = 0;
+    uint32_t listen_saved_baud_ = 0;
+    bool listen_saved_flow_ = false;
+
+    char echo_[Log::RAW_BYTES];
+    size_t echo_len_ = 0;
+
+    // Tiempos de ida y vuelta con el ESP (Metrics): último comando, último
+    // AT+CIPSEND esperando '>' y últimos datos esperando "SEND OK"
+    uint32_t at_sent_us_ = 0;
+    uint32_t data_sent_us_ = 0;
+    bool at_pending_ = false;
+    bool prompt_pending_ = false;
+    bool data_pending_ = false;
+
+    // Cuerpo de /api/metrics: no cabe en body_buffer() y se comparte entre
+    // enlaces (uno a la vez)
+    static const size_t METRICS_BODY_SIZE = 1280;
+    char metrics_body_[METRICS_BODY_SIZE];
+    int metrics_owner_ = -1;
+
+    // Espera bloqueante en curso (begin, start_server)
+    const AtTokenizer::Kind* wait_kinds_ = nullptr;
+    int wait_n_ = 0;
+    int wait_hit_ = -1;
 
     // --- Helpers UART/AT ---
+    // Todos leen del buffer RX por interrupción, nunca de la FIFO hardware,
+    // y todo lo leído pasa por el tokenizador.
+    int  rx_getc(absolute_time_t deadline);  // -1 si vence el plazo
+    void echo(int ch);                       // eco al log (módulo ESP)
+    bool pump(absolute_time_t deadline);     // un byte al tokenizador
     void uart_send_raw(const char* s);
     void send_at(const char* cmd);
     void flush_uart_quiet(uint32_t quiet_ms);
-    int  wait_for_any(const char* const tokens[], int ntokens, uint32_t timeout_ms);
-    bool wait_for(const char* tok, uint32_t timeout_ms);
-    int  read_bytes(uint8_t* buf, int maxlen, uint32_t timeout_ms);
+    // Índice de la primera respuesta de kinds que llegue, -1 si vence
+    int  wait_for_any(const AtTokenizer::Kind kinds[], int nkinds, uint32_t timeout_ms);
+    bool wait_for(AtTokenizer::Kind kind, uint32_t timeout_ms);
+
+    // Salida del tokenizador
+    static void on_at_event(void* ctx, const AtTokenizer::Event& ev);
+    static void on_ipd_data(void* ctx, int link, const uint8_t* data, size_t len);
+    // Mide la respuesta del ESP contra el comando o los datos que la piden
+    void time_reply(AtTokenizer::Kind kind);
 
-    // +IPD o "ready" tras reset: 1=+IPD, -2=ready, 0=timeout/otro
-    int  wait_ipd_or_ready(int* out_id, int* out_len, uint32_t timeout_ms);
+    // E/S de los enlaces y del cliente HTTP hacia el ESP
+    static void esp_send_command(void* ctx, const char* cmd);
+    static void esp_send_data(void* ctx, const TxSegment* segs, int count);
 
-    // HTTP con CIPMUX=1
-    void send_http_200(int id);
-    void send_http_404(int id);
-    void send_api_sensor_json(int id);
+    // Arranca la respuesta del siguiente enlace con la petición completa
+    void serve_next();
+    // Analiza la petición, elige la ruta y prepara la respuesta
+    void dispatch(HttpConnection& conn);
+    void respond_error(HttpConnection& conn, const char* status, const char* extra_headers);
+
+    // Manejadores de la tabla de rutas (ver dispatch). false -> 500.
+    using RouteHandler = bool (Esp8266HttpServer::*)(HttpConnection& conn, const HttpRequest& req);
+    bool route_index(HttpConnection& conn, const HttpRequest& req);
+    bool route_api_sensor(HttpConnection& conn, const HttpRequest& req);
+    bool route_api_stream(HttpConnection& conn, const HttpRequest& req);
+    bool route_api_metrics(HttpConnection& conn, const HttpRequest& req);
+    bool route_favicon(HttpConnection& conn, const HttpRequest& req);
+    int  format_sensor_json(char* out, size_t size) const;
 
     // CIPMUX=1, CIPSERVER=1,80 (+ CIPSTO). Imprime estado.
     bool start_server();
+
+    // Velocidad del enlace: prueba cfg::UART_FAST_BAUDS en orden y se queda
+    // en la primera que verifica; ante cualquier fallo vuelve a UART_BAUD.
+    void negotiate_baud();
+    bool recover_boot_baud(uint32_t tried, bool flow);
+    void set_host_baud(uint32_t baud, bool flow);
+    bool verify_link();
+    // Errores de trama a velocidad alta: con una ráfaga se pasa a escuchar
+    // a UART_BAUD (reboot_listen_until_us_) sin bloquear
+    void watch_framing_errors();
+    // Paso de poll() durante esa escucha; false cuando termina
+    bool poll_reboot_listen(uint32_t budget_us);
     
     // Simulación del sensor MPU6050
     void read_mpu6050(float* accel_x, float* accel_y, float* accel_z);
     float calculate_magnitude(float x, float y, float z);
 
 private:
-    uint8_t reqbuf_[cfg::REQ_BUFFER_SIZE] = {0};
+    UartRxRing rx_;
+    UartDmaTx tx_;
+    AsyncHttpClient client_{cfg::API_LINK_ID};
+    AtTokenizer at_;
+    HttpConnection conns_[MAX_LINKS];
+    SseHub stream_;
 };
@@ -0,0 +1,101 @@
+#include "EventCapture.h"
+#include "Log.h"
+
+EventCapture::EventCapture()
+    : active(-1), phase(ARMED), captured(0), missed(0) {
+    for (int i = 0; i < cfg::CAPTURE_RECORDS; i++) {
+        state[i].store(FREE, std::memory_order_relaxed);
+    }
+    arm_next();
+}
+
+void EventCapture::arm_next() {
+    active = -1;
+    phase = ARMED;
+    for (int i = 0; i < cfg::CAPTURE_RECORDS; i++) {
+        if (state[i].load(std::memory_order_acquire) == FREE) {
+            CaptureRecord& r = records[i];
+            r.pre_head = 0;
+            r.pre_count = 0;
+            r.count = 0;
+            r.truncated = false;
+            state[i].store(ACTIVE, std::memory_order_relaxed);
+            active = i;
+            return;
+        }
+    }
+}
+
+void EventCapture::push(const SensorData& raw) {
+    // Sin registro libre: reintentar por si el consumidor ya liberó uno
+    if (active < 0) {
+        arm_next();
+        if (active < 0) return;
+    }
+
+    CaptureRecord& r = records[active];
+    CaptureSample s = { raw.accel_x, raw.accel_y, raw.accel_z };
+
+    if (phase == ARMED) {
+        r.samples[r.pre_head] = s;
+        r.pre_head = (r.pre_head + 1) % CaptureRecord::PRE_SAMPLES;
+        if (r.pre_count < CaptureRecord::PRE_SAMPLES) r.pre_count++;
+        r.trigger_us = raw.timestamp_us;
+        return;
+    }
+
+    r.samples[CaptureRecord::PRE_SAMPLES + (r.count - r.pre_count)] = s;
+    r.count++;
+
+    // El evento sigue en el tracker; la captura acaba aquí y espera al siguiente
+    if (r.count - r.pre_count >= CaptureRecord::MAX_SAMPLES - CaptureRecord::PRE_SAMPLES) {
+        r.truncated = true;
+        finish();
+    }
+}
+
+void EventCapture::trigger(uint32_t event_id, uint32_t sta_lta_ratio_q8) {
+    // Un evento nuevo sin haber cerrado el anterior: cada registro lleva un
+    // único id, así que el anterior se da por terminado
+    if (phase == RECORDING) finish();
+
+    // La muestra del disparo ya entró con push(): es la última del anillo
+
+    if (active < 0) arm_next();
+    if (active < 0) {
+        missed.fetch_add(1, std::memory_order_relaxed);
+        Log::warn(Log::CAPTURE, "Sin registro libre, evento sin forma de onda\n");
+        return;
+    }
+    // Congelar el anillo tal cual; lo siguiente se escribe detrás
+    CaptureRecord& r = records[active];
+    r.event_id = event_id;
+    r.sta_lta_ratio_q8 = sta_lta_ratio_q8;
+    r.count = r.pre_count;
+    phase = RECORDING;
+}
+
+void EventCapture::detrigger() {
+    if (phase == RECORDING) finish();
+}
+
+void EventCapture::finish() {
+    state[active].store(READY, std::memory_order_release);
+    captured.fetch_add(1, std::memory_order_relaxed);
+    arm_next();
+}
+
+const CaptureRecord* EventCapture::acquire() {
+    const CaptureRecord* oldest = nullptr;
+    for (int i = 0; i < cfg::CAPTURE_RECORDS; i++) {
+        if (state[i].load(std::memory_order_acquire) != READY) continue;
+        if (!oldest || records[i].event_id < oldest->event_id) oldest = &records[i];
+    }
+    return oldest;
+}
+
+void EventCapture::release(const CaptureRecord* record) {
+    int i = (int)(record - records);
+    if (i < 0 || i >= cfg::CAPTURE_RECORDS) return;
+    state[i].store(FREE, std::memory_order_release);
+}
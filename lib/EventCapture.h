@@ -0,0 +1,103 @@
+#ifndef EVENT_CAPTURE_H_
+#define EVENT_CAPTURE_H_
+
+#include <atomic>
+#include <cstdint>
+#include "MPU6050.h"
+#include "../Config.h"
+
+// Muestra compacta de la forma de onda: aceleración calibrada sin filtrar,
+// en cuentas. El instante se deduce del índice y de la frecuencia de muestreo.
+struct CaptureSample {
+    int16_t ax;
+    int16_t ay;
+    int16_t az;
+};
+
+// Registro de un evento: historia previa al disparo + evento. El evento lo
+// delimita EventTracker, así que termina con sus EVENT_QUIET_S de calma.
+//
+// Mientras está armado, el registro hace de anillo de pre-disparo sobre sus
+// primeras PRE_SAMPLES posiciones. Al disparar, el anillo se congela tal cual
+// (sin copiar) y las muestras siguientes se escriben a continuación. at()
+// desenrolla el anillo, así que el lector ve una serie lineal.
+struct CaptureRecord {
+    static const uint32_t PRE_SAMPLES = cfg::CAPTURE_PRE_TRIGGER_S * cfg::SAMPLE_RATE_HZ;
+    static const uint32_t MAX_SAMPLES = cfg::CAPTURE_MAX_RECORD_S * cfg::SAMPLE_RATE_HZ;
+    static_assert(MAX_SAMPLES > PRE_SAMPLES, "el registro debe superar el pre-disparo");
+
+    uint32_t event_id;
+    uint64_t trigger_us;       // instante de la muestra que disparó
+    uint32_t pre_count;        // muestras hasta el disparo incluido (<= PRE_SAMPLES)
+    uint32_t count;            // muestras totales del registro
+    uint32_t sta_lta_ratio_q8; // STA/LTA en el disparo
+    bool     truncated;        // se alcanzó MAX_SAMPLES antes del final
+
+    // Muestra i-ésima en orden temporal (0 = la más antigua)
+    const CaptureSample& at(uint32_t i) const {
+        if (i < pre_count) {
+            uint32_t first = pre_head - pre_count + PRE_SAMPLES;
+            return samples[(first + i) % PRE_SAMPLES];
+        }
+        return samples[PRE_SAMPLES + (i - pre_count)];
+    }
+
+    // Instante (µs) de la primera muestra
+    uint64_t start_us() const {
+        if (pre_count == 0) return trigger_us;
+        return trigger_us - (uint64_t)(pre_count - 1) * 1000000ULL / cfg::SAMPLE_RATE_HZ;
+    }
+
+private:
+    friend class EventCapture;
+    uint32_t pre_head;         // siguiente posición del anillo de pre-disparo
+    CaptureSample samples[MAX_SAMPLES];
+};
+
+// Subsistema de captura. push()/trigger()/detrigger() los llama solo el
+// productor (muestreo, core1 en modo doble núcleo) y nunca esperan. Sigue
+// los flancos de EventTracker: trigger() en ONSET con su event_id y
+// detrigger() en ENDED, de modo que cada forma de onda lleva el mismo id que
+// el evento que anuncia el servidor. El
+// consumidor (subida en core0) toma registros completos con acquire() y los
+// devuelve con release(). El traspaso es por el estado atómico de cada
+// registro: el productor nunca toca uno que no sea FREE o suyo.
+class EventCapture {
+public:
+    EventCapture();
+
+    // ===== Productor =====
+    void push(const SensorData& raw);
+    void trigger(uint32_t event_id, uint32_t sta_lta_ratio_q8);   // tras el push() de la muestra que disparó
+    void detrigger();                                             // fin del evento: el registro queda listo
+
+    // ===== Consumidor =====
+    // Registro listo más antiguo, o nullptr. Sigue siendo del consumidor
+    // hasta release().
+    const CaptureRecord* acquire();
+    void release(const CaptureRecord* record);
+
+    // Estadísticas
+    uint32_t events_captured() const { return captured.load(std::memory_order_relaxed); }
+    uint32_t events_missed() const { return missed.load(std::memory_order_relaxed); }
+    bool is_recording() const { return phase != ARMED; }
+
+private:
+    enum State : uint8_t { FREE, ACTIVE, READY };
+    enum Phase : uint8_t { ARMED, RECORDING };
+
+    void arm_next();
+    void finish();
+
+    CaptureRecord records[cfg::CAPTURE_RECORDS];
+    std::atomic<uint8_t> state[cfg::CAPTURE_RECORDS];
+
+    // Solo productor
+    int active;               // registro en uso, -1 si no hay ninguno libre
+    Phase phase;
+
+    std::atomic<uint32_t> captured;
+    std::atomic<uint32_t> missed;
+};
+
+#endif // EVENT_CAPTURE_H_
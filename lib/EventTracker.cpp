@@ -0,0 +1,64 @@
+#include "EventTracker.h"
+#include <cstring>
+
+static const uint64_t QUIET_US = (uint64_t)cfg::EVENT_QUIET_S * 1000000u;
+static const uint64_t MAX_DURATION_US = (uint64_t)cfg::EVENT_MAX_DURATION_S * 1000000u;
+
+static_assert(cfg::EVENT_QUIET_S > 0 && cfg::EVENT_MAX_DURATION_S > cfg::EVENT_QUIET_S,
+              "la espera de fin debe ser menor que la duración máxima");
+
+static inline uint16_t abs16(int16_t v) {
+    return (uint16_t)(v < 0 ? -(int32_t)v : v);
+}
+
+EventTracker::EventTracker() : state(IDLE), quiet_since_us(0), next_id(1), count(0) {
+    memset(&summary, 0, sizeof(summary));
+}
+
+EventTracker::Edge EventTracker::update(const SensorData& data, bool active, uint32_t ratio_q8) {
+    if (state == IDLE) {
+        if (!active) return NONE;
+
+        memset(&summary, 0, sizeof(summary));
+        summary.event_id = next_id++;
+        count++;
+        summary.onset = data;
+        summary.onset_ratio_q8 = ratio_q8;
+        summary.peak = data;
+        summary.peak_ratio_q8 = ratio_q8;
+        summary.last_active_us = data.timestamp_us;
+        summary.triggers = 1;
+        accumulate(data);
+        state = ONGOING;
+        return ONSET;
+    }
+
+    accumulate(data);
+
+    if (active) {
+        if (state == QUIET && summary.triggers < UINT16_MAX) summary.triggers++;
+        state = ONGOING;
+        summary.last_active_us = data.timestamp_us;
+        if (ratio_q8 > summary.peak_ratio_q8) summary.peak_ratio_q8 = ratio_q8;
+    } else if (state == ONGOING) {
+        state = QUIET;
+        quiet_since_us = data.timestamp_us;
+    }
+
+    bool quiet_over = state == QUIET && data.timestamp_us - quiet_since_us >= QUIET_US;
+    bool too_long = data.timestamp_us - summary.onset.timestamp_us >= MAX_DURATION_US;
+    if (!quiet_over && !too_long) return NONE;
+
+    // Un evento cortado por duración sigue, si hay disparo, como otro nuevo
+    summary.truncated = !quiet_over;
+    state = IDLE;
+    return ENDED;
+}
+
+void EventTracker::accumulate(const SensorData& data) {
+    uint16_t a[3] = {abs16(data.accel_x), abs16(data.accel_y), abs16(data.accel_z)};
+    for (int k = 0; k < 3; k++) {
+        if (a[k] > summary.pga[k]) summary.pga[k] = a[k];
+    }
+    if (data.magnitude_sq > summary.peak.magnitude_sq) summary.peak = data;
+}
@@ -0,0 +1,68 @@
+#ifndef EVENT_TRACKER_H_
+#define EVENT_TRACKER_H_
+
+#include <cstdint>
+#include "MPU6050.h"  // Para SensorData
+#include "../Config.h"
+
+// Ciclo de vida de un evento sísmico: inicio -> en curso -> fin.
+//
+// Recibe cada muestra filtrada junto con "hay disparo" (STA/LTA disparado o,
+// mientras la LTA se calienta, |a| sobre el umbral de terremoto). Los
+// disparos seguidos se funden en un único evento: tras el último, el evento
+// sigue abierto cfg::EVENT_QUIET_S y un disparo dentro de esa espera lo
+// continúa. Mientras dura se acumulan el PGA por eje y la muestra de |a|
+// máxima. update() avisa dos veces por evento: ONSET con la primera muestra
+// y ENDED con el resumen completo. O(1) por muestra y sin divisiones; lo usa
+// solo el productor.
+class EventTracker {
+public:
+    enum Phase : uint8_t {
+        IDLE,       // sin evento
+        ONGOING,    // disparado
+        QUIET,      // sin disparo, esperando a ver si sigue
+    };
+
+    enum Edge : uint8_t { NONE, ONSET, ENDED };
+
+    struct Summary {
+        uint32_t event_id;
+        SensorData onset;           // muestra que abrió el evento
+        uint32_t onset_ratio_q8;    // STA/LTA al abrirlo
+        uint64_t last_active_us;    // última muestra con disparo
+        SensorData peak;            // muestra de |a| máxima
+        uint32_t peak_ratio_q8;     // STA/LTA máxima
+        uint16_t pga[3];            // |a| máxima por eje (cuentas, filtrada)
+        uint16_t triggers;          // disparos fundidos en el evento
+        bool truncated;             // cortado al llegar a EVENT_MAX_DURATION_S
+
+        uint32_t duration_ms() const {
+            return (uint32_t)((last_active_us - onset.timestamp_us) / 1000u) +
+                   1000u / cfg::SAMPLE_RATE_HZ;
+        }
+    };
+
+    EventTracker();
+
+    // Id del próximo evento; solo antes de la primera muestra
+    void set_next_id(uint32_t id) { next_id = id; }
+
+    // ratio_q8 solo se mira con active (el llamador evita la división)
+    Edge update(const SensorData& data, bool active, uint32_t ratio_q8);
+
+    Phase phase() const { return state; }
+    // Evento en curso o, tras ENDED, el que acaba de cerrarse
+    const Summary& current() const { return summary; }
+    uint32_t events() const { return count; }
+
+private:
+    void accumulate(const SensorData& data);
+
+    Phase state;
+    Summary summary;
+    uint64_t quiet_since_us;
+    uint32_t next_id;
+    uint32_t count;
+};
+
+#endif // EVENT_TRACKER_H_
@@ -0,0 +1,120 @@
+#include "FixedPoint.h"
+#include "hardware/structs/systick.h"
+#include "pico/stdlib.h"
+#include <cmath>
+#include <cstdio>
+
+namespace fx {
+
+uint32_t isqrt32(uint32_t v) {
+    uint32_t res = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > v) bit >>= 2;
+    while (bit != 0) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+// ===== Benchmark =====
+
+namespace {
+
+const int BENCH_SAMPLES = 64;
+const int BENCH_ROUNDS = 100;
+
+// Evita que el compilador elimine los cálculos
+volatile float sink_f;
+volatile uint32_t sink_u;
+
+// SysTick es un contador descendente de 24 bits a clk_sys
+inline void systick_start() {
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;  // habilitado, reloj del procesador
+}
+inline uint32_t systick_now() { return systick_hw->cvr; }
+inline uint32_t systick_elapsed(uint32_t start, uint32_t end) {
+    return (start - end) & 0x00FFFFFF;
+}
+
+// Conversión tal como se hacía antes: divisiones, productos y sqrt en float
+__attribute__((noinline)) void convert_float(const int16_t* raw, int n) {
+    const float off_x = 0.12f, off_y = -0.05f, off_z = 0.20f;
+    for (int i = 0; i < n; i++) {
+        const int16_t* r = &raw[i * 6];
+        float ax = ((float)r[0] / cfg::ACCEL_SCALE_FACTOR * cfg::GRAVITY) - off_x;
+        float ay = ((float)r[1] / cfg::ACCEL_SCALE_FACTOR * cfg::GRAVITY) - off_y;
+        float az = ((float)r[2] / cfg::ACCEL_SCALE_FACTOR * cfg::GRAVITY) - off_z;
+        float gx = (float)r[3] / 131.0f;
+        float gy = (float)r[4] / 131.0f;
+        float gz = (float)r[5] / 131.0f;
+        float mag = sqrt(ax * ax + ay * ay + az * az);
+        sink_f = mag + gx + gy + gz;
+        sink_u = mag > cfg::VIBRATION_THRESHOLD;
+    }
+}
+
+// Conversión actual: offsets en cuentas, |a|² entero y raíz entera
+__attribute__((noinline)) void convert_fixed(const int16_t* raw, int n) {
+    const int16_t off_x = 200, off_y = -84, off_z = 334;
+    for (int i = 0; i < n; i++) {
+        const int16_t* r = &raw[i * 6];
+        int32_t ax = clamp_i16(r[0] - off_x);
+        int32_t ay = clamp_i16(r[1] - off_y);
+        int32_t az = clamp_i16(r[2] - off_z);
+        uint32_t mag_sq = magnitude_sq(ax, ay, az);
+        sink_u = isqrt32(mag_sq) + r[3] + r[4] + r[5];
+        sink_u = mag_sq > VIBRATION_THRESHOLD_SQ;
+    }
+}
+
+} // namespace
+
+void run_conversion_benchmark() {
+    static int16_t raw[BENCH_SAMPLES * 6];
+    uint32_t seed = 12345;
+    for (int i = 0; i < BENCH_SAMPLES * 6; i++) {
+        seed = seed * 1103515245u + 12345u;
+        raw[i] = (int16_t)((seed >> 16) & 0x3FFF) - 0x2000;
+    }
+
+    systick_start();
+
+    uint32_t t0 = systick_now();
+    convert_float(raw, BENCH_SAMPLES);
+    uint32_t t1 = systick_now();
+    convert_fixed(raw, BENCH_SAMPLES);
+    uint32_t t2 = systick_now();
+
+    uint32_t float_cycles = systick_elapsed(t0, t1);
+    uint32_t fixed_cycles = systick_elapsed(t1, t2);
+
+    // Lo mismo en tiempo de pared, repetido para que time_us_32 resuelva
+    uint32_t u0 = time_us_32();
+    for (int k = 0; k < BENCH_ROUNDS; k++) convert_float(raw, BENCH_SAMPLES);
+    uint32_t u1 = time_us_32();
+    for (int k = 0; k < BENCH_ROUNDS; k++) convert_fixed(raw, BENCH_SAMPLES);
+    uint32_t u2 = time_us_32();
+    const uint32_t total = BENCH_SAMPLES * BENCH_ROUNDS;
+
+    printf("[FX] Conversión de %d muestras (ciclos totales / por muestra):\n", BENCH_SAMPLES);
+    printf("[FX]   float (soft-float): %lu / %lu\n",
+           (unsigned long)float_cycles, (unsigned long)(float_cycles / BENCH_SAMPLES));
+    printf("[FX]   entero + isqrt    : %lu / %lu\n",
+           (unsigned long)fixed_cycles, (unsigned long)(fixed_cycles / BENCH_SAMPLES));
+    if (fixed_cycles > 0) {
+        printf("[FX]   aceleración x%lu\n", (unsigned long)(float_cycles / fixed_cycles));
+    }
+    // ns por muestra; el coste real en marcha se ve en /api/metrics ("process")
+    printf("[FX]   ns/muestra: float %lu, entero %lu\n",
+           (unsigned long)((u1 - u0) * 1000u / total), (unsigned long)((u2 - u1) * 1000u / total));
+}
+
+} // namespace fx
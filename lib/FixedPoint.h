@@ -0,0 +1,73 @@
+#ifndef FIXED_POINT_H_
+#define FIXED_POINT_H_
+
+#include <cstdint>
+#include "../Config.h"
+
+// Aritmética entera / punto fijo para el Cortex-M0+ (sin FPU).
+//
+// Las muestras viajan en cuentas del sensor: a ±2 g el acelerómetro da
+// 16384 cuentas por g, es decir Q14 en unidades de g. Los umbrales se pasan
+// a cuentas (y al cuadrado) en tiempo de compilación, así que la detección
+// compara enteros. El float solo aparece al formatear JSON o texto.
+namespace fx {
+
+    // ===== Q16.16 genérico =====
+    using q16_t = int32_t;
+    inline constexpr int     Q16_SHIFT = 16;
+    inline constexpr q16_t   Q16_ONE   = 1 << Q16_SHIFT;
+
+    constexpr q16_t to_q16(float v) {
+        return (q16_t)(v * (float)Q16_ONE + (v >= 0.0f ? 0.5f : -0.5f));
+    }
+    constexpr q16_t q16_mul(q16_t a, q16_t b) {
+        return (q16_t)(((int64_t)a * b) >> Q16_SHIFT);
+    }
+
+    // ===== Escalas del MPU6050 =====
+    inline constexpr int32_t ACCEL_COUNTS_PER_G   = (int32_t)cfg::ACCEL_SCALE_FACTOR;
+    inline constexpr int32_t GYRO_COUNTS_PER_DPS  = 131;  // rango ±250 °/s
+
+    // m/s² -> cuentas (solo en compilación)
+    constexpr int32_t accel_counts(float mps2) {
+        return (int32_t)(mps2 / cfg::GRAVITY * cfg::ACCEL_SCALE_FACTOR + 0.5f);
+    }
+    constexpr uint32_t accel_counts_sq(float mps2) {
+        return (uint32_t)accel_counts(mps2) * (uint32_t)accel_counts(mps2);
+    }
+
+    // Umbrales de detección pre-elevados al cuadrado
+    inline constexpr uint32_t VIBRATION_THRESHOLD_SQ  = accel_counts_sq(cfg::VIBRATION_THRESHOLD);
+    inline constexpr uint32_t EARTHQUAKE_THRESHOLD_SQ = accel_counts_sq(cfg::EARTHQUAKE_THRESHOLD);
+
+    inline int16_t clamp_i16(int32_t v) {
+        return (int16_t)(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+    }
+
+    // |a|² en cuentas². Con tres ejes int16 cabe en uint32 (3·2^30 < 2^32).
+    inline uint32_t magnitude_sq(int32_t x, int32_t y, int32_t z) {
+        return (uint32_t)(x * x) + (uint32_t)(y * y) + (uint32_t)(z * z);
+    }
+
+    // Raíz cuadrada entera (redondeo hacia abajo), sin divisiones.
+    uint32_t isqrt32(uint32_t v);
+
+    // ===== Frontera JSON / texto =====
+    inline float accel_to_mps2(int32_t counts) {
+        return (float)counts * (cfg::GRAVITY / cfg::ACCEL_SCALE_FACTOR);
+    }
+    inline float accel_sq_to_mps2sq(uint32_t counts_sq) {
+        return (float)counts_sq * ((cfg::GRAVITY / cfg::ACCEL_SCALE_FACTOR) *
+                                   (cfg::GRAVITY / cfg::ACCEL_SCALE_FACTOR));
+    }
+    inline float gyro_to_dps(int32_t counts) {
+        return (float)counts * (1.0f / (float)GYRO_COUNTS_PER_DPS);
+    }
+
+    // Compara en ciclos (SysTick) la conversión antigua en float con la
+    // actual en enteros e imprime el resultado por USB.
+    void run_conversion_benchmark();
+
+} // namespace fx
+
+#endif // FIXED_POINT_H_
@@ -0,0 +1,412 @@
+#include "FlashJournal.h"
+#include "pico/flash.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+// Fin del firmware en flash (símbolo del enlazador)
+extern char __flash_binary_end;
+
+static const uint32_t SECTOR_MAGIC = 0x4C4E524Au;  // "JRNL"
+static const uint16_t RECORD_MAGIC = 0x5245;      // "ER"
+static const uint16_t FLAG_CLEAR = 0x0000;
+static const uint16_t FLAG_UNSET = 0xFFFF;
+
+struct FlashJournal::SectorHeader {
+    uint32_t magic;
+    uint32_t seq;           // orden de uso del sector
+    uint32_t erases;        // borrados acumulados de este sector
+    uint32_t crc;
+};
+
+struct FlashJournal::RecordHeader {
+    uint16_t magic;
+    uint8_t type;
+    uint8_t reserved;
+    uint32_t seq;
+    uint16_t len;
+    uint16_t commit;        // 0xFFFF hasta que todas las páginas están grabadas
+    uint16_t ack;           // 0xFFFF hasta que el API confirma la entrega
+    uint16_t pad;
+    uint32_t crc;           // cabecera hasta len + carga
+};
+
+static const size_t CRC_HEADER_BYTES = 10;   // magic, type, reserved, seq, len
+
+// CRC-32 (IEEE, reflejado) con tabla de 16 entradas: 64 bytes de tabla
+static uint32_t crc32_update(uint32_t crc, const uint8_t* p, size_t len) {
+    static const uint32_t kTable[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ kTable[crc & 0x0F];
+        crc = (crc >> 4) ^ kTable[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+// Los registros van seguidos, alineados a 16 bytes; el primero empieza tras
+// la cabecera del sector
+static const uint32_t RECORD_ALIGN = 16;
+static const uint32_t FIRST_RECORD = 16;
+
+static uint32_t record_size(uint16_t len, size_t header) {
+    uint32_t n = (uint32_t)(header + len);
+    return (n + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+}
+
+FlashJournal::FlashJournal(uint32_t region_offset, uint32_t sectors)
+    : region(region_offset), num_sectors(sectors), is_ready(false),
+      head(0), head_off(0), tail(0), next_sector_seq(1), next_seq(1), max_erases(0),
+      scan_from(0), spare_ready(false), spare_erases(0),
+      read_overruns(nullptr), overruns_ctx(nullptr), overruns_during_flash(0),
+      pending_count(0), appended_count(0), acked_count(0),
+      lost_count(0), corrupt_count(0) {
+    static_assert(sizeof(RecordHeader) == 20, "cabecera de registro sin relleno");
+    memset(page, 0xFF, sizeof(page));
+    memset(cursors, 0, sizeof(cursors));
+}
+
+// ===== Acceso a la flash =====
+
+struct FlashOp {
+    uint32_t offset;
+    const uint8_t* data;
+    size_t len;
+};
+
+static void do_program(void* p) {
+    const FlashOp* op = (const FlashOp*)p;
+    flash_range_program(op->offset, op->data, op->len);
+}
+
+static void do_erase(void* p) {
+    const FlashOp* op = (const FlashOp*)p;
+    flash_range_erase(op->offset, op->len);
+}
+
+void FlashJournal::set_overrun_counter(uint32_t (*read)(void* ctx), void* ctx) {
+    read_overruns = read;
+    overruns_ctx = ctx;
+}
+
+bool FlashJournal::program(uint32_t offset, const uint8_t* data, size_t len) {
+    FlashOp op = {offset, data, len};
+    uint32_t before = read_overruns ? read_overruns(overruns_ctx) : 0;
+    bool ok = flash_safe_execute(do_program, &op, 100) == PICO_OK;
+    if (read_overruns) overruns_during_flash += read_overruns(overruns_ctx) - before;
+    return ok;
+}
+
+bool FlashJournal::erase(uint32_t offset) {
+    FlashOp op = {offset, nullptr, SECTOR_SIZE};
+    uint32_t before = read_overruns ? read_overruns(overruns_ctx) : 0;
+    bool ok = flash_safe_execute(do_erase, &op, 500) == PICO_OK;
+    if (read_overruns) overruns_during_flash += read_overruns(overruns_ctx) - before;
+    return ok;
+}
+
+// Pone a cero un campo de 16 bits: el resto de la página se programa a 0xFF
+// y no cambia nada
+bool FlashJournal::clear_field(uint32_t record_offset, size_t field_offset) {
+    uint32_t at = record_offset + (uint32_t)field_offset;
+    uint32_t page_start = at & ~(PAGE_SIZE - 1);
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page + (at - page_start), &FLAG_CLEAR, sizeof(FLAG_CLEAR));
+    return program(page_start, page, PAGE_SIZE);
+}
+
+// ===== Lectura =====
+
+bool FlashJournal::read_sector_header(uint32_t s, uint32_t* seq, uint32_t* erases) const {
+    SectorHeader h;
+    memcpy(&h, flash_ptr(sector_offset(s)), sizeof(h));
+    if (h.magic != SECTOR_MAGIC) return false;
+    if (h.crc != crc32_update(0, (const uint8_t*)&h, offsetof(SectorHeader, crc))) return false;
+    if (seq) *seq = h.seq;
+    if (erases) *erases = h.erases;
+    return true;
+}
+
+template <typename Visit>
+uint32_t FlashJournal::walk_sector(uint32_t s, uint32_t from, Visit visit) const {
+    uint32_t base = sector_offset(s);
+    uint32_t off = from;
+    while (off + sizeof(RecordHeader) <= SECTOR_SIZE) {
+        RecordHeader h;
+        memcpy(&h, flash_ptr(base + off), sizeof(h));
+        if (h.magic == FLAG_UNSET) return off;           // hueco borrado: fin
+        uint32_t size = record_size(h.len, sizeof(RecordHeader));
+        if (h.magic != RECORD_MAGIC || h.len > MAX_RECORD || off + size > SECTOR_SIZE) {
+            return SECTOR_SIZE;                          // basura: sector cerrado
+        }
+        if (!visit(base + off, h)) return off;
+        off += size;
+    }
+    return SECTOR_SIZE;
+}
+
+uint32_t FlashJournal::next_record(uint32_t offset, uint16_t len) const {
+    uint32_t next = offset + record_size(len, sizeof(RecordHeader));
+    if ((next - region) % SECTOR_SIZE == 0) {
+        next = sector_offset((next - region) / SECTOR_SIZE % num_sectors) + FIRST_RECORD;
+    }
+    return next;
+}
+
+bool FlashJournal::record_valid(uint32_t offset, const RecordHeader& h) const {
+    if (h.commit != FLAG_CLEAR) return false;
+    uint32_t crc = crc32_update(0, (const uint8_t*)&h, CRC_HEADER_BYTES);
+    crc = crc32_update(crc, flash_ptr(offset + sizeof(RecordHeader)), h.len);
+    return crc == h.crc;
+}
+
+// ===== Arranque =====
+
+bool FlashJournal::begin() {
+    is_ready = false;
+    uint32_t binary_end = (uint32_t)((uintptr_t)&__flash_binary_end - XIP_BASE);
+    if (num_sectors < 2 || region % SECTOR_SIZE != 0 ||
+        region < binary_end || region + num_sectors * SECTOR_SIZE > PICO_FLASH_SIZE_BYTES) {
+        printf("Diario: zona de flash inválida (0x%08lx, %lu sectores, firmware hasta 0x%08lx)\n",
+               (unsigned long)region, (unsigned long)num_sectors, (unsigned long)binary_end);
+        return false;
+    }
+
+    // Sectores en uso: el de secuencia más alta es el de escritura y el de
+    // la más baja el más antiguo
+    bool any = false;
+    uint32_t min_seq = 0, max_seq = 0;
+    for (uint32_t s = 0; s < num_sectors; s++) {
+        uint32_t seq, erases;
+        if (!read_sector_header(s, &seq, &erases)) continue;
+        if (erases > max_erases) max_erases = erases;
+        if (!any || seq < min_seq) { min_seq = seq; tail = s; }
+        if (!any || seq > max_seq) { max_seq = seq; head = s; }
+        any = true;
+    }
+
+    if (!any) {
+        printf("Diario: formateando %lu sectores\n", (unsigned long)num_sectors);
+        next_sector_seq = 1;
+        tail = 0;
+        if (!erase(sector_offset(0)) || !open_sector(0, 1)) return false;
+        scan_from = sector_offset(tail) + FIRST_RECORD;
+        is_ready = true;
+        return true;
+    }
+    next_sector_seq = max_seq + 1;
+
+    // Recorrer del más antiguo al de escritura: pendientes, registros
+    // rotos y siguiente número de secuencia
+    for (uint32_t s = tail;; s = (s + 1) % num_sectors) {
+        uint32_t end = walk_sector(s, FIRST_RECORD, [&](uint32_t off, const RecordHeader& h) {
+            if (!record_valid(off, h)) {
+                corrupt_count++;
+            } else {
+                if (h.seq >= next_seq) next_seq = h.seq + 1;
+                if (h.ack == FLAG_UNSET) pending_count++;
+            }
+            return true;
+        });
+        if (s == head) {
+            head_off = end;
+            break;
+        }
+    }
+    scan_from = sector_offset(tail) + FIRST_RECORD;
+    is_ready = true;
+
+    printf("Diario: %lu pendientes, %lu rotos, sector %lu+%lu, borrados máx %lu\n",
+           (unsigned long)pending_count, (unsigned long)corrupt_count,
+           (unsigned long)head, (unsigned long)head_off, (unsigned long)max_erases);
+    return true;
+}
+
+// Escribe la cabecera del sector s (ya borrado) con el siguiente número de
+// secuencia y lo deja como sector de escritura
+bool FlashJournal::open_sector(uint32_t s, uint32_t erases) {
+    SectorHeader h;
+    h.magic = SECTOR_MAGIC;
+    h.seq = next_sector_seq;
+    h.erases = erases;
+    h.crc = crc32_update(0, (const uint8_t*)&h, offsetof(SectorHeader, crc));
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &h, sizeof(h));
+    if (!program(sector_offset(s), page, PAGE_SIZE)) return false;
+
+    next_sector_seq++;
+    if (h.erases > max_erases) max_erases = h.erases;
+    head = s;
+    head_off = FIRST_RECORD;
+    return true;
+}
+
+// ===== Escritura =====
+
+bool FlashJournal::prepare() {
+    if (!is_ready || spare_ready) return true;
+    uint32_t next = (head + 1) % num_sectors;
+    if (next == tail) {
+        // Anillo lleno: se recupera el sector más antiguo
+        uint32_t lost = 0;
+        walk_sector(tail, FIRST_RECORD, [&](uint32_t off, const RecordHeader& h) {
+            if (h.ack == FLAG_UNSET && record_valid(off, h)) lost++;
+            return true;
+        });
+        lost_count += lost;
+        pending_count -= lost < pending_count ? lost : pending_count;
+        if (scan_from / SECTOR_SIZE == sector_offset(tail) / SECTOR_SIZE) {
+            scan_from = sector_offset((tail + 1) % num_sectors) + FIRST_RECORD;
+        }
+        tail = (tail + 1) % num_sectors;
+        memset(cursors, 0, sizeof(cursors));
+    }
+
+    uint32_t erases = max_erases;
+    read_sector_header(next, nullptr, &erases);
+    if (!erase(sector_offset(next))) {
+        printf("Diario: fallo al borrar el sector %lu\n", (unsigned long)next);
+        return false;
+    }
+    spare_erases = erases + 1;
+    spare_ready = true;
+    return true;
+}
+
+bool FlashJournal::needs_erase(size_t len) const {
+    if (!is_ready || len > MAX_RECORD) return false;
+    return head_off + record_size((uint16_t)len, sizeof(RecordHeader)) > SECTOR_SIZE && !spare_ready;
+}
+
+bool FlashJournal::append(RecordType type, const void* data, size_t len) {
+    if (!is_ready || len > MAX_RECORD) return false;
+    uint32_t size = record_size((uint16_t)len, sizeof(RecordHeader));
+
+    if (head_off + size > SECTOR_SIZE) {
+        // Solo se pasa a un sector que prepare() ya dejó borrado
+        if (!spare_ready) return false;
+        uint32_t next = (head + 1) % num_sectors;
+        spare_ready = false;    // con la cabecera a medias hay que borrarlo otra vez
+        if (!open_sector(next, spare_erases)) {
+            printf("Diario: fallo al abrir el sector %lu\n", (unsigned long)next);
+            return false;
+        }
+    }
+
+    RecordHeader h;
+    h.magic = RECORD_MAGIC;
+    h.type = type;
+    h.reserved = 0xFF;
+    h.seq = next_seq;
+    h.len = (uint16_t)len;
+    h.commit = FLAG_UNSET;
+    h.ack = FLAG_UNSET;
+    h.pad = 0xFFFF;
+    uint32_t crc = crc32_update(0, (const uint8_t*)&h, CRC_HEADER_BYTES);
+    h.crc = crc32_update(crc, (const uint8_t*)data, len);
+
+    // Paso 1: cabecera y carga, página a página, sin commit. Los bytes de
+    // la página que no son del registro se programan a 0xFF: el registro
+    // anterior que comparta página no cambia.
+    uint32_t offset = sector_offset(head) + head_off;
+    uint32_t end = offset + (uint32_t)(sizeof(h) + len);
+    for (uint32_t p = offset & ~(PAGE_SIZE - 1); p < end; p += PAGE_SIZE) {
+        memset(page, 0xFF, sizeof(page));
+        uint32_t from = p > offset ? p : offset;
+        uint32_t to = p + PAGE_SIZE < end ? p + PAGE_SIZE : end;
+        for (uint32_t a = from; a < to; a++) {
+            uint32_t k = a - offset;
+            page[a - p] = k < sizeof(h) ? ((const uint8_t*)&h)[k]
+                                        : ((const uint8_t*)data)[k - sizeof(h)];
+        }
+        if (!program(p, page, PAGE_SIZE)) break;
+    }
+    next_seq++;
+
+    // Paso 2: commit y comprobación
+    RecordHeader check;
+    bool ok = clear_field(offset, offsetof(RecordHeader, commit));
+    memcpy(&check, flash_ptr(offset), sizeof(check));
+    if (!ok || !record_valid(offset, check)) {
+        // Un registro a medias puede dejar un hueco que el recorrido no sabe
+        // saltar: se cierra el sector y el siguiente append abre otro
+        corrupt_count++;
+        head_off = SECTOR_SIZE;
+        return false;
+    }
+    head_off += size;
+    appended_count++;
+    pending_count++;
+    return true;
+}
+
+// ===== Reenvío =====
+
+bool FlashJournal::peek(Entry& out, uint8_t type, uint32_t after_seq) {
+    if (!is_ready || pending_count == 0) return false;
+    bool filtered = type != 0 || after_seq != 0;
+
+    // Desde scan_from hacia delante hasta el sector de escritura. Mientras
+    // solo aparezcan registros entregados o rotos, scan_from avanza con la
+    // búsqueda. Si after_seq es el último devuelto de ese tipo se retoma
+    // tras él: todo lo anterior tiene secuencia menor.
+    uint32_t start = scan_from;
+    if (type != 0 && type < NUM_TYPES && after_seq != 0 && cursors[type].seq == after_seq) {
+        start = cursors[type].next;
+    }
+    bool leading = start == scan_from;
+    uint32_t s = (start - region) / SECTOR_SIZE;
+    uint32_t from = (start - region) % SECTOR_SIZE;
+    for (;;) {
+        bool found = false;
+        walk_sector(s, from, [&](uint32_t off, const RecordHeader& h) {
+            // Primero lo que dice la cabecera; el CRC, solo del candidato
+            bool done = h.ack != FLAG_UNSET || h.commit != FLAG_CLEAR;
+            if (!done && (type == 0 || h.type == type) && (int32_t)(h.seq - after_seq) > 0) {
+                if (record_valid(off, h)) {
+                    out.offset = off;
+                    out.seq = h.seq;
+                    out.type = h.type;
+                    out.len = h.len;
+                    out.data = flash_ptr(off + sizeof(RecordHeader));
+                    if (type != 0 && type < NUM_TYPES) cursors[type] = Cursor{h.seq, next_record(off, h.len)};
+                    found = true;
+                    return false;
+                }
+                done = true;    // CRC roto
+            }
+            if (!done) {
+                leading = false;
+            } else if (leading) {
+                scan_from = next_record(off, h.len);
+            }
+            return true;
+        });
+        if (found) return true;
+        if (s == head) break;
+        s = (s + 1) % num_sectors;
+        from = FIRST_RECORD;
+        if (leading) scan_from = sector_offset(s) + FIRST_RECORD;
+    }
+    // Sin filtro y sin ninguno: el contador estaba desfasado
+    if (!filtered && leading) pending_count = 0;
+    return false;
+}
+
+void FlashJournal::ack(const Entry& e) {
+    if (!is_ready) return;
+    // El sector pudo reciclarse mientras el registro estaba en vuelo
+    RecordHeader h;
+    memcpy(&h, flash_ptr(e.offset), sizeof(h));
+    if (h.magic != RECORD_MAGIC || h.seq != e.seq || h.ack != FLAG_UNSET) return;
+
+    if (!clear_field(e.offset, offsetof(RecordHeader, ack))) return;
+    acked_count++;
+    if (pending_count > 0) pending_count--;
+    if (scan_from == e.offset) scan_from = next_record(e.offset, h.len);
+}
@@ -0,0 +1,157 @@
+#ifndef FLASH_JOURNAL_H_
+#define FLASH_JOURNAL_H_
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include <cstddef>
+#include <cstdint>
+
+// Diario de solo-añadir en una zona reservada al final de la flash QSPI.
+//
+// Los eventos y las formas de onda se escriben aquí antes de subirlos y se
+// reenvían al API, del más antiguo al más nuevo, cuando hay conectividad;
+// solo el acuse (2xx) los da por entregados. Sobrevive a reinicios.
+//
+// Formato: cada sector empieza con una cabecera (número de secuencia y
+// contador de borrados) seguida de registros alineados a 16 bytes. Un registro
+// es cabecera + carga con CRC-32. Se graba en dos pasos: primero todas las
+// páginas con "commit" sin marcar y después se limpia ese campo; si se va la
+// luz a medias, el registro queda sin commit y se ignora. El acuse también
+// limpia bits (0xFFFF -> 0), así que nunca hace falta borrar para marcar.
+//
+// Los sectores se usan en anillo: cada borrado va al siguiente, de modo que
+// el desgaste se reparte por igual. Con el anillo lleno se recupera el sector
+// más antiguo; sus registros sin acuse se pierden y se cuentan.
+//
+// Borrar un sector (~50 ms) detiene la ejecución desde flash en los dos
+// núcleos (flash_safe_execute); core1 debe llamar a
+// flash_safe_execute_core_init() al arrancar. Con las interrupciones de
+// core0 paradas la FIFO RX del UART (32 bytes) se desborda enseguida, así
+// que append() nunca borra: prepare() deja borrado el sector siguiente y el
+// dueño la llama cuando el enlace con el ESP está en silencio.
+class FlashJournal {
+public:
+    enum RecordType : uint8_t {
+        REC_EVENT    = 1,   // JSON de evento
+        REC_WAVEFORM = 2,   // lote binario (lib/BatchFormat.h)
+    };
+
+    // Registro listo para reenviar. data apunta a la flash (XIP) y vale
+    // hasta el siguiente append().
+    struct Entry {
+        uint32_t offset;    // posición del registro en la flash
+        uint32_t seq;
+        uint8_t type;
+        uint16_t len;
+        const uint8_t* data;
+    };
+
+    static const uint32_t SECTOR_SIZE = FLASH_SECTOR_SIZE;
+    static const uint32_t PAGE_SIZE = FLASH_PAGE_SIZE;
+    static const size_t MAX_RECORD = SECTOR_SIZE - PAGE_SIZE;
+
+    FlashJournal(uint32_t region_offset, uint32_t sectors);
+
+    // Recorre la zona y recupera el estado; la formatea si está vacía.
+    // false si la zona pisa el firmware o la flash no responde.
+    bool begin();
+    bool ready() const { return is_ready; }
+
+    // false si falla la flash o si el registro necesita sector nuevo y
+    // prepare() aún no lo ha borrado (needs_erase)
+    bool append(RecordType type, const void* data, size_t len);
+
+    // Borra el sector siguiente al de escritura (recuperando el más antiguo
+    // si el anillo está lleno) para que append() no tenga que hacerlo
+    bool prepare();
+    bool prepared() const { return spare_ready; }
+    // Un registro de len bytes no cabe en el sector actual y no hay otro borrado
+    bool needs_erase(size_t len) const;
+
+    // Contador de desbordes del UART que se lee antes y después de cada
+    // operación de flash; lo que suba se le apunta al diario
+    void set_overrun_counter(uint32_t (*read)(void* ctx), void* ctx);
+
+    // Registro sin acuse más antiguo; false si no queda ninguno. Con type
+    // solo los de ese tipo; con after_seq solo los posteriores (los
+    // anteriores ya están en camino). Tipo y secuencia se miran en la
+    // cabecera; el CRC solo se calcula del registro que se va a devolver.
+    // Si after_seq es el último que devolvió para ese tipo, sigue desde él.
+    bool peek(Entry& out, uint8_t type = 0, uint32_t after_seq = 0);
+    // Marca el registro como entregado
+    void ack(const Entry& e);
+
+    // Estadísticas
+    uint32_t pending() const { return pending_count; }
+    uint32_t appended() const { return appended_count; }
+    uint32_t acked() const { return acked_count; }
+    uint32_t lost() const { return lost_count; }          // pisados sin acuse
+    uint32_t corrupt() const { return corrupt_count; }    // CRC o cabecera rotos
+    uint32_t max_erase_count() const { return max_erases; }
+    uint32_t flash_overruns() const { return overruns_during_flash; }
+    uint32_t sectors() const { return num_sectors; }
+    // Secuencia del próximo registro: solo crece y se recupera en begin()
+    uint32_t next_sequence() const { return next_seq; }
+
+private:
+    struct SectorHeader;
+    struct RecordHeader;
+
+    uint32_t sector_offset(uint32_t s) const { return region + s * SECTOR_SIZE; }
+    const uint8_t* flash_ptr(uint32_t offset) const { return (const uint8_t*)(uintptr_t)(XIP_BASE + offset); }
+
+    bool read_sector_header(uint32_t s, uint32_t* seq, uint32_t* erases) const;
+    // Recorre los registros del sector s desde el desplazamiento from.
+    // visit(offset, cabecera) devuelve false para parar. Devuelve dónde se
+    // paró (o SECTOR_SIZE si encontró basura: el sector se da por lleno).
+    template <typename Visit>
+    uint32_t walk_sector(uint32_t s, uint32_t from, Visit visit) const;
+    bool record_valid(uint32_t offset, const RecordHeader& h) const;
+    // Offset del registro siguiente; al final de un sector, el primero del
+    // que le sigue en el anillo
+    uint32_t next_record(uint32_t offset, uint16_t len) const;
+
+    bool open_sector(uint32_t s, uint32_t erases);
+    bool program(uint32_t offset, const uint8_t* data, size_t len);
+    bool erase(uint32_t offset);
+    bool clear_field(uint32_t record_offset, size_t field_offset);
+
+    uint32_t region;
+    uint32_t num_sectors;
+    bool is_ready;
+
+    uint32_t head;              // sector de escritura
+    uint32_t head_off;          // siguiente página libre en head
+    uint32_t tail;              // sector más antiguo con datos
+    uint32_t next_sector_seq;
+    uint32_t next_seq;
+    uint32_t max_erases;
+
+    uint32_t scan_from;         // offset desde el que buscar el siguiente pendiente
+
+    // Último registro que devolvió peek() para cada tipo y dónde sigue la
+    // búsqueda. Se invalidan al recuperar un sector.
+    struct Cursor {
+        uint32_t seq;
+        uint32_t next;
+    };
+    static const int NUM_TYPES = REC_WAVEFORM + 1;
+    Cursor cursors[NUM_TYPES];
+
+    bool spare_ready;           // el sector head + 1 está borrado
+    uint32_t spare_erases;      // contador de borrados que llevará su cabecera
+
+    uint32_t (*read_overruns)(void* ctx);
+    void* overruns_ctx;
+    uint32_t overruns_during_flash;
+
+    uint32_t pending_count;
+    uint32_t appended_count;
+    uint32_t acked_count;
+    uint32_t lost_count;
+    uint32_t corrupt_count;
+
+    uint8_t page[FLASH_PAGE_SIZE];
+};
+
+#endif // FLASH_JOURNAL_H_
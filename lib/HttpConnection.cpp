@@ -0,0 +1,309 @@
+#include "HttpConnection.h"
+#include "Log.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+// Plazos de cada fase (ms)
+static const uint32_t PROMPT_TIMEOUT_MS  = 2000;
+static const uint32_t SEND_OK_TIMEOUT_MS = 3000;
+static const uint32_t CLOSE_TIMEOUT_MS   = 1000;
+
+HttpConnection::HttpConnection()
+    : io{nullptr, nullptr, nullptr}, link(-1), st(FREE), phase(IDLE),
+      deadline_us(0), peer_closed(false), reopened(false), stream(false), last_tx_us(0), len(0), header_end(-1),
+      overflow(false), header_len(0), total_len(0), sent(0), chunk_len(0),
+      dropped_frames(0) {
+    buf[0] = '\0';
+    memset(segs, 0, sizeof(segs));
+}
+
+void HttpConnection::setup(int link_id, const Io& io) {
+    link = link_id;
+    this->io = io;
+}
+
+// ===== Recepción =====
+
+void HttpConnection::on_open() {
+    // El ESP reutiliza el enlace tras el CLOSED aunque la respuesta anterior
+    // siga en vuelo: se deja terminar y la petición nueva espera en buf
+    if (phase != IDLE) {
+        if (!reopened) {
+            reopened = true;
+            begin_request();
+        }
+        return;
+    }
+    st = RECEIVING;
+    peer_closed = false;
+    begin_request();
+}
+
+void HttpConnection::begin_request() {
+    len = 0;
+    header_end = -1;
+    overflow = false;
+    buf[0] = '\0';
+}
+
+void HttpConnection::on_data(const uint8_t* data, size_t n) {
+    // Un "n,CONNECT" perdido no impide atender la petición
+    if (st == FREE || (peer_closed && !reopened)) on_open();
+    if (reopened) {
+        // Cliente nuevo con la respuesta anterior en vuelo: se acumula y
+        // finish() la pasa a READY
+        append(data, n);
+        return;
+    }
+    if (st != RECEIVING) {
+        dropped_frames++;
+        return;
+    }
+
+    size_t scan_from = (size_t)len;
+    append(data, n);
+
+    // Con el buffer lleno se atiende lo que haya: la línea de petición y
+    // las primeras cabeceras bastan para elegir la ruta
+    if (check_complete(scan_from) || overflow) st = READY;
+}
+
+void HttpConnection::append(const uint8_t* data, size_t n) {
+    size_t room = (size_t)cfg::REQ_BUFFER_SIZE - (size_t)len;
+    if (n > room) {
+        n = room;
+        overflow = true;
+    }
+    memcpy(buf + len, data, n);
+    len += (int)n;
+    buf[len] = '\0';
+}
+
+bool HttpConnection::check_complete(size_t scan_from) {
+    if (header_end < 0) {
+        size_t from = scan_from > 3 ? scan_from - 3 : 0;
+        for (size_t i = from; i + 4 <= (size_t)len; i++) {
+            if (memcmp(buf + i, "\r\n\r\n", 4) == 0) {
+                header_end = (int)(i + 4);
+                break;
+            }
+        }
+        if (header_end < 0) return false;
+    }
+
+    // Cuerpo declarado en Content-Length
+    long content_length = 0;
+    const char* p = buf;
+    const char* end = buf + header_end;
+    while (p < end) {
+        const char* eol = (const char*)memchr(p, '\n', (size_t)(end - p));
+        if (!eol) break;
+        if (eol - p > 15 && strncasecmp(p, "Content-Length:", 15) == 0) {
+            content_length = strtol(p + 15, nullptr, 10);
+            break;
+        }
+        p = eol + 1;
+    }
+    return content_length <= 0 || len - header_end >= content_length;
+}
+
+void HttpConnection::on_closed() {
+    if (phase != IDLE) {
+        // Falta la respuesta del ESP al comando en curso (ERROR, SEND FAIL...).
+        // Si el que cierra es el cliente nuevo, su petición ya no sirve.
+        if (reopened) {
+            reopened = false;
+            begin_request();
+        }
+        peer_closed = true;
+        return;
+    }
+    st = FREE;
+    stream = false;
+    len = 0;
+    header_end = -1;
+}
+
+void HttpConnection::reset() {
+    stream = false;
+    st = FREE;
+    phase = IDLE;
+    len = 0;
+    header_end = -1;
+    peer_closed = false;
+    reopened = false;
+}
+
+// ===== Respuesta =====
+
+bool HttpConnection::respond(const char* status, const char* content_type,
+                             const void* body_data, size_t body_len,
+                             const char* extra_headers) {
+    char type_line[80] = "";
+    if (content_type) snprintf(type_line, sizeof(type_line), "Content-Type: %s\r\n", content_type);
+    header_len = snprintf(header, sizeof(header),
+        "HTTP/1.1 %s\r\n"
+        "%s"
+        "Content-Length: %u\r\n"
+        "%s"
+        "Connection: close\r\n\r\n",
+        status, type_line, (unsigned)body_len,
+        extra_headers ? extra_headers : "");
+    if (header_len <= 0 || header_len >= (int)sizeof(header)) {
+        Log::warn(Log::HTTP, "Cabecera demasiado larga en enlace %d\n", link);
+        return false;
+    }
+    segs[0] = TxSegment{header, (size_t)header_len};
+    segs[1] = TxSegment{body_data, body_len};
+    total_len = (size_t)header_len + body_len;
+    return true;
+}
+
+bool HttpConnection::respond_stream(const char* content_type, const char* extra_headers,
+                                    const char* preamble) {
+    header_len = snprintf(header, sizeof(header),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: %s\r\n"
+        "Cache-Control: no-cache\r\n"
+        "%s"
+        "Connection: keep-alive\r\n\r\n"
+        "%s",
+        content_type, extra_headers ? extra_headers : "", preamble ? preamble : "");
+    if (header_len <= 0 || header_len >= (int)sizeof(header)) {
+        Log::warn(Log::HTTP, "Cabecera demasiado larga en enlace %d\n", link);
+        return false;
+    }
+    segs[0] = TxSegment{header, (size_t)header_len};
+    segs[1] = TxSegment{nullptr, 0};
+    total_len = (size_t)header_len;
+    stream = true;
+    return true;
+}
+
+bool HttpConnection::push(const void* data, size_t n) {
+    if (!can_push() || n == 0 || n > sizeof(body)) return false;
+    memcpy(body, data, n);
+    segs[0] = TxSegment{body, n};
+    segs[1] = TxSegment{nullptr, 0};
+    total_len = n;
+    sent = 0;
+    send_next_chunk();
+    return true;
+}
+
+void HttpConnection::start() {
+    st = RESPONDING;
+    sent = 0;
+    if (peer_closed) {
+        finish();
+        return;
+    }
+    send_next_chunk();
+}
+
+void HttpConnection::send_next_chunk() {
+    chunk_len = total_len - sent;
+    if (chunk_len > (size_t)cfg::CIPSEND_MAX_BYTES) chunk_len = (size_t)cfg::CIPSEND_MAX_BYTES;
+    send_command_for(PROMPT, PROMPT_TIMEOUT_MS, "AT+CIPSEND=%d,%d", link, (int)chunk_len);
+}
+
+// Tramos de [sent, sent + chunk_len) sobre cabecera + cuerpo
+int HttpConnection::chunk_segments(TxSegment out[2]) const {
+    int n = 0;
+    size_t off = sent;
+    size_t left = chunk_len;
+    for (int i = 0; i < 2 && left > 0; i++) {
+        if (off >= segs[i].len) {
+            off -= segs[i].len;
+            continue;
+        }
+        size_t take = segs[i].len - off;
+        if (take > left) take = left;
+        out[n++] = TxSegment{(const uint8_t*)segs[i].data + off, take};
+        left -= take;
+        off = 0;
+    }
+    return n;
+}
+
+void HttpConnection::send_command_for(Phase next, uint32_t timeout_ms, const char* fmt, int a, int b) {
+    char cmd[40];
+    snprintf(cmd, sizeof(cmd), fmt, a, b);
+    phase = next;
+    deadline_us = time_us_64() + (uint64_t)timeout_ms * 1000;
+    if (io.send_command) io.send_command(io.ctx, cmd);
+}
+
+void HttpConnection::poll() {
+    if (phase == IDLE || time_us_64() < deadline_us) return;
+
+    if (phase == CLOSING) {
+        finish();
+    } else {
+        Log::warn(Log::HTTP, "Timeout en enlace %d (fase %d)\n", link, (int)phase);
+        send_command_for(CLOSING, CLOSE_TIMEOUT_MS, "AT+CIPCLOSE=%d", link);
+    }
+}
+
+void HttpConnection::on_at_reply(AtTokenizer::Kind reply) {
+    switch (phase) {
+    case PROMPT:
+        if (reply == AtTokenizer::PROMPT) {
+            TxSegment chunk[2];
+            int count = chunk_segments(chunk);
+            phase = SENDING;
+            deadline_us = time_us_64() + SEND_OK_TIMEOUT_MS * 1000;
+            if (io.send_data) io.send_data(io.ctx, chunk, count);
+        } else if (reply == AtTokenizer::ERROR || reply == AtTokenizer::LINK_INVALID) {
+            finish();   // el enlace ya no existe
+        }
+        break;
+
+    case SENDING:
+        if (reply == AtTokenizer::SEND_OK) {
+            sent += chunk_len;
+            last_tx_us = time_us_64();
+            if (sent < total_len && !peer_closed) {
+                send_next_chunk();
+            } else if (peer_closed) {
+                finish();
+            } else if (stream) {
+                phase = IDLE;
+                st = STREAMING;
+            } else {
+                send_command_for(CLOSING, CLOSE_TIMEOUT_MS, "AT+CIPCLOSE=%d", link);
+            }
+        } else if (reply == AtTokenizer::SEND_FAIL || reply == AtTokenizer::ERROR) {
+            Log::warn(Log::HTTP, "Error enviando respuesta en enlace %d\n", link);
+            send_command_for(CLOSING, CLOSE_TIMEOUT_MS, "AT+CIPCLOSE=%d", link);
+        }
+        break;
+
+    case CLOSING:
+        if (reply == AtTokenizer::OK || reply == AtTokenizer::ERROR ||
+            reply == AtTokenizer::LINK_INVALID) {
+            finish();
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void HttpConnection::finish() {
+    stream = false;
+    phase = IDLE;
+    peer_closed = false;
+    if (reopened) {
+        // Atender la petición que llegó mientras tanto
+        reopened = false;
+        st = (len > 0 && (check_complete(0) || overflow)) ? READY : RECEIVING;
+        return;
+    }
+    st = FREE;
+    len = 0;
+    header_end = -1;
+}
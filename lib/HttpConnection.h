@@ -0,0 +1,134 @@
+#ifndef HTTP_CONNECTION_H_
+#define HTTP_CONNECTION_H_
+
+#include "pico/stdlib.h"
+#include <cstddef>
+#include <cstdint>
+#include "../Config.h"
+#include "UartDmaTx.h"
+#include "AtTokenizer.h"
+
+// Estado de un enlace CIPMUX del servidor HTTP.
+//
+// Recepción: las tramas +IPD del enlace se van acumulando en su propio
+// buffer hasta tener la cabecera completa (y el cuerpo, si trae
+// Content-Length), aunque la petición llegue partida en varias tramas.
+// Si el cliente cierra con la respuesta aún en vuelo y el ESP reutiliza el
+// enlace para otro, la petición nueva se guarda en el buffer (que la
+// respuesta ya no usa) y se atiende al terminar la anterior.
+//
+// Stream: respond_stream() deja el enlace abierto tras la cabecera
+// (STREAMING) y push() envía cada mensaje con su propio CIPSEND.
+//
+// Respuesta: respond() prepara la cabecera y start() lanza la máquina
+// CIPSEND -> datos -> CIPCLOSE; las respuestas de más de
+// cfg::CIPSEND_MAX_BYTES salen en varios CIPSEND, leyendo el cuerpo
+// directamente de donde esté (flash). Avanza con las respuestas del ESP que le
+// pasa el servidor (on_at_reply) y con poll() para los plazos. Nada espera al
+// ESP, así que mientras un enlace espera "SEND OK" se sigue recibiendo en
+// los demás. Solo un enlace puede tener un comando AT en vuelo a la vez; eso
+// lo arbitra el servidor.
+class HttpConnection {
+public:
+    enum State : uint8_t {
+        FREE,           // sin cliente
+        RECEIVING,      // acumulando la petición
+        READY,          // petición completa, falta respuesta
+        RESPONDING,     // respuesta en curso
+        STREAMING,      // cabecera enviada, enlace abierto para push()
+    };
+
+    // E/S hacia el ESP8266; la aporta el dueño del UART
+    struct Io {
+        void* ctx;
+        void (*send_command)(void* ctx, const char* cmd);
+        void (*send_data)(void* ctx, const TxSegment* segs, int count);
+    };
+
+    HttpConnection();
+    void setup(int link_id, const Io& io);
+
+    // ===== Recepción (lado del lector del UART) =====
+    void on_open();                         // "n,CONNECT"
+    void on_data(const uint8_t* data, size_t len);
+    void on_closed();                       // "n,CLOSED"
+    void reset();                           // el ESP se reinició
+
+    // Petición completa (en el buffer, terminada en '\0')
+    const char* request() const { return buf; }
+    int  request_len() const { return len; }
+    bool truncated() const { return overflow; }
+
+    // ===== Respuesta =====
+    // Buffer propio para cuerpos generados (JSON); vive hasta el cierre
+    char* body_buffer() { return body; }
+    static const size_t BODY_SIZE = 384;
+
+    // Prepara la respuesta. body debe seguir vivo hasta el cierre (estático
+    // o body_buffer()). content_type y extra_headers pueden ser nullptr;
+    // extra_headers son líneas terminadas en CRLF.
+    bool respond(const char* status, const char* content_type,
+                 const void* body_data, size_t body_len,
+                 const char* extra_headers = nullptr);
+    // Respuesta sin Content-Length que no se cierra (text/event-stream).
+    // preamble va tras la cabecera en el mismo CIPSEND.
+    bool respond_stream(const char* content_type, const char* extra_headers,
+                        const char* preamble);
+    // Envía AT+CIPSEND; a partir de aquí manda on_at_reply()
+    void start();
+
+    // Con STREAMING y sin comando en vuelo: copia y envía un mensaje
+    bool can_push() const { return st == STREAMING && phase == IDLE; }
+    bool push(const void* data, size_t len);
+    // Abierto para stream (incluida la cabecera aún en vuelo)
+    bool streaming() const { return stream; }
+    uint64_t last_push_us() const { return last_tx_us; }
+
+    void poll();
+    void on_at_reply(AtTokenizer::Kind reply);
+
+    // Hay un comando AT de este enlace esperando respuesta
+    bool at_outstanding() const { return phase != IDLE; }
+
+    State state() const { return st; }
+    int   link_id() const { return link; }
+    uint32_t dropped() const { return dropped_frames; }
+
+private:
+    enum Phase : uint8_t { IDLE, PROMPT, SENDING, CLOSING };
+
+    void begin_request();
+    void append(const uint8_t* data, size_t n);
+    bool check_complete(size_t scan_from);
+    void send_command_for(Phase next, uint32_t timeout_ms, const char* fmt, int a, int b = 0);
+    void send_next_chunk();
+    int  chunk_segments(TxSegment out[2]) const;
+    void finish();
+
+    Io io;
+    int link;
+    State st;
+    Phase phase;
+    uint64_t deadline_us;
+    bool peer_closed;           // el cliente cerró con la respuesta en curso
+    bool reopened;              // y otro cliente ya ocupa el enlace: su petición espera en buf
+    bool stream;                // no cerrar tras enviar
+    uint64_t last_tx_us;
+
+    char buf[cfg::REQ_BUFFER_SIZE + 1];
+    int len;
+    int header_end;             // tras "\r\n\r\n", -1 si aún no llegó
+    bool overflow;
+
+    char header[256];
+    int header_len;
+    char body[BODY_SIZE];
+    TxSegment segs[2];
+    size_t total_len;           // cabecera + cuerpo
+    size_t sent;                // bytes ya confirmados con SEND OK
+    size_t chunk_len;           // bytes del CIPSEND en curso
+
+    uint32_t dropped_frames;    // datos del mismo cliente tras su petición completa
+};
+
+#endif // HTTP_CONNECTION_H_
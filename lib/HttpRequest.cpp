@@ -0,0 +1,155 @@
+#include "HttpRequest.h"
+#include <cstring>
+
+static inline int hexval(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return 10 + c - 'A';
+    if (c >= 'a' && c <= 'f') return 10 + c - 'a';
+    return -1;
+}
+
+// Un '%' sin dos dígitos hexadecimales detrás se copia tal cual
+static void percent_decode(char* s, bool plus_is_space) {
+    char* w = s;
+    for (char* r = s; *r;) {
+        if (*r == '%') {
+            int h1 = hexval(r[1]);
+            int h2 = h1 >= 0 ? hexval(r[2]) : -1;
+            if (h2 >= 0) {
+                *w++ = (char)((h1 << 4) | h2);
+                r += 3;
+                continue;
+            }
+        }
+        *w++ = (plus_is_space && *r == '+') ? ' ' : *r;
+        r++;
+    }
+    *w = '\0';
+}
+
+void HttpRequest::url_decode_inplace(char* s) {
+    percent_decode(s, true);
+}
+
+void HttpRequest::path_decode_inplace(char* s) {
+    percent_decode(s, false);
+}
+
+static inline char lower(char c) { return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c; }
+
+bool HttpRequest::iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (lower(a[i]) != lower(b[i])) return false;
+    }
+    return true;
+}
+
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+HttpRequest::Method HttpRequest::parse_method(std::string_view text) {
+    static const struct { const char* name; Method method; } kMethods[] = {
+        {"GET", GET}, {"HEAD", HEAD}, {"POST", POST}, {"PUT", PUT},
+        {"DELETE", DELETE}, {"OPTIONS", OPTIONS}, {"PATCH", PATCH},
+    };
+    for (const auto& m : kMethods) {
+        if (text == m.name) return m.method;   // los métodos distinguen mayúsculas
+    }
+    return UNKNOWN;
+}
+
+const char* HttpRequest::method_name(Method m) {
+    static const char* const kNames[] = {"GET", "HEAD", "POST", "PUT", "DELETE", "OPTIONS", "PATCH"};
+    return m < UNKNOWN ? kNames[m] : "?";
+}
+
+bool HttpRequest::parse(const char* data, size_t len) {
+    std::string_view buf(data, len);
+    method = UNKNOWN;
+    method_text = target = path = query = version = std::string_view();
+    num_headers = 0;
+    truncated = false;
+
+    // Línea de petición: MÉTODO SP destino SP HTTP/1.x CRLF
+    size_t eol = buf.find('\n');
+    if (eol == std::string_view::npos) return false;
+    std::string_view line = buf.substr(0, eol);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    size_t sp1 = line.find(' ');
+    if (sp1 == std::string_view::npos || sp1 == 0) return false;
+    size_t sp2 = line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos || sp2 == sp1 + 1) return false;
+
+    method_text = line.substr(0, sp1);
+    target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    version = line.substr(sp2 + 1);
+    if (version.size() != 8 || version.substr(0, 7) != "HTTP/1.") return false;
+    if (target.front() != '/') return false;   // ni forma absoluta ni "*"
+
+    method = parse_method(method_text);
+    size_t q = target.find('?');
+    path = target.substr(0, q);
+    if (q != std::string_view::npos) query = target.substr(q + 1);
+    size_t frag = query.find('#');
+    if (frag != std::string_view::npos) query = query.substr(0, frag);
+
+    // Cabeceras hasta la línea vacía (o hasta donde llegue el buffer)
+    size_t pos = eol + 1;
+    while (pos < buf.size()) {
+        size_t e = buf.find('\n', pos);
+        std::string_view h = buf.substr(pos, e == std::string_view::npos ? std::string_view::npos : e - pos);
+        if (!h.empty() && h.back() == '\r') h.remove_suffix(1);
+        if (h.empty()) break;
+
+        size_t colon = h.find(':');
+        if (colon != std::string_view::npos && colon > 0) {
+            if (num_headers < MAX_HEADERS) {
+                headers[num_headers++] = Header{h.substr(0, colon), trim(h.substr(colon + 1))};
+            } else {
+                truncated = true;
+            }
+        }
+        if (e == std::string_view::npos) break;
+        pos = e + 1;
+    }
+    return true;
+}
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (int i = 0; i < num_headers; i++) {
+        if (iequals(headers[i].name, name)) return headers[i].value;
+    }
+    return std::string_view();
+}
+
+bool HttpRequest::has_header(std::string_view name) const {
+    for (int i = 0; i < num_headers; i++) {
+        if (iequals(headers[i].name, name)) return true;
+    }
+    return false;
+}
+
+bool HttpRequest::query_param(std::string_view name, char* out, size_t out_size) const {
+    std::string_view rest = query;
+    while (!rest.empty()) {
+        size_t amp = rest.find('&');
+        std::string_view pair = rest.substr(0, amp);
+        rest = amp == std::string_view::npos ? std::string_view() : rest.substr(amp + 1);
+
+        size_t eq = pair.find('=');
+        std::string_view key = pair.substr(0, eq);
+        if (key != name) continue;
+        std::string_view value = eq == std::string_view::npos ? std::string_view() : pair.substr(eq + 1);
+        if (value.size() >= out_size) return false;
+        memcpy(out, value.data(), value.size());
+        out[value.size()] = '\0';
+        url_decode_inplace(out);
+        return true;
+    }
+    return false;
+}
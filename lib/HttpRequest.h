@@ -0,0 +1,66 @@
+#ifndef HTTP_REQUEST_H_
+#define HTTP_REQUEST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Petición HTTP/1.x analizada sin copias.
+//
+// parse() recorre el buffer de recepción y deja string_view a la línea de
+// petición (método, ruta, query, versión) y a cada cabecera; el buffer debe
+// seguir vivo mientras se use la petición. Solo query_param() copia, porque
+// decodifica %xx y '+' en el buffer del llamador.
+class HttpRequest {
+public:
+    enum Method : uint8_t { GET, HEAD, POST, PUT, DELETE, OPTIONS, PATCH, UNKNOWN };
+
+    struct Header {
+        std::string_view name;
+        std::string_view value;     // sin espacios alrededor
+    };
+
+    static const int MAX_HEADERS = 16;
+
+    // false si la línea de petición está mal formada o no es HTTP/1.x.
+    // Un método desconocido no es error: queda como UNKNOWN.
+    bool parse(const char* data, size_t len);
+
+    Method method = UNKNOWN;
+    std::string_view method_text;
+    std::string_view target;        // ruta + query tal como llegaron
+    std::string_view path;          // sin decodificar
+    std::string_view query;         // sin '?', vacío si no hay
+    std::string_view version;
+
+    int header_count() const { return num_headers; }
+    const Header& header_at(int i) const { return headers[i]; }
+    // Cabeceras que no cupieron en MAX_HEADERS
+    bool headers_truncated() const { return truncated; }
+
+    // Valor de la cabecera (sin distinguir mayúsculas); vacío si no está
+    std::string_view header(std::string_view name) const;
+    bool has_header(std::string_view name) const;
+
+    // Parámetro de la query decodificado en out ('\0' final). false si no
+    // está o no cabe.
+    bool query_param(std::string_view name, char* out, size_t out_size) const;
+
+    static Method parse_method(std::string_view text);
+    static const char* method_name(Method m);
+
+    // Decodifica %xx y '+' (espacio) sobre la propia cadena; para valores
+    // de la query (application/x-www-form-urlencoded)
+    static void url_decode_inplace(char* s);
+    // Solo %xx: en la ruta '+' es un carácter literal
+    static void path_decode_inplace(char* s);
+
+    static bool iequals(std::string_view a, std::string_view b);
+
+private:
+    Header headers[MAX_HEADERS];
+    int num_headers = 0;
+    bool truncated = false;
+};
+
+#endif // HTTP_REQUEST_H_
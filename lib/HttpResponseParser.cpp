@@ -0,0 +1,114 @@
+#include "HttpResponseParser.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+void HttpResponseParser::reset() {
+    state = STATUS_LINE;
+    line_len = 0;
+    status_code = 0;
+    content_length = -1;
+    body_left = 0;
+    keep_alive_ = false;
+}
+
+// Prefijo sin distinguir mayúsculas; devuelve el resto de la línea o nullptr
+static const char* header_value(const char* line, const char* name) {
+    size_t n = strlen(name);
+    for (size_t i = 0; i < n; i++) {
+        if (tolower((unsigned char)line[i]) != name[i]) return nullptr;
+    }
+    const char* v = line + n;
+    while (*v == ' ' || *v == '\t') v++;
+    return v;
+}
+
+static bool contains_token(const char* value, const char* token) {
+    size_t n = strlen(token);
+    for (const char* p = value; *p; p++) {
+        size_t i = 0;
+        while (i < n && p[i] && tolower((unsigned char)p[i]) == token[i]) i++;
+        if (i == n) return true;
+    }
+    return false;
+}
+
+void HttpResponseParser::on_line() {
+    line[line_len] = '\0';
+
+    if (state == STATUS_LINE) {
+        // "HTTP/1.1 200 OK"
+        if (line_len < 12 || strncmp(line, "HTTP/1.", 7) != 0) {
+            state = FAILED;
+            return;
+        }
+        status_code = atoi(line + 9);
+        keep_alive_ = line[7] == '1';   // HTTP/1.1 mantiene la conexión por defecto
+        state = HEADERS;
+        return;
+    }
+
+    if (line_len == 0) {
+        end_of_headers();
+        return;
+    }
+
+    const char* v;
+    if ((v = header_value(line, "content-length:")) != nullptr) {
+        content_length = atoi(v);
+    } else if ((v = header_value(line, "connection:")) != nullptr) {
+        if (contains_token(v, "close")) keep_alive_ = false;
+        else if (contains_token(v, "keep-alive")) keep_alive_ = true;
+    } else if ((v = header_value(line, "transfer-encoding:")) != nullptr) {
+        // Sin decodificar trozos no se sabe dónde acaba: leer hasta el cierre
+        if (contains_token(v, "chunked")) keep_alive_ = false;
+    }
+}
+
+void HttpResponseParser::end_of_headers() {
+    // Respuestas sin cuerpo por definición
+    if (status_code < 200 || status_code == 204 || status_code == 304) {
+        state = DONE;
+        return;
+    }
+    if (content_length >= 0) {
+        body_left = content_length;
+        state = body_left > 0 ? BODY : DONE;
+        return;
+    }
+    // Cuerpo delimitado por el cierre de la conexión
+    keep_alive_ = false;
+    state = BODY;
+}
+
+size_t HttpResponseParser::feed(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len && state != DONE && state != FAILED) {
+        if (state == BODY) {
+            size_t n = len - i;
+            if (content_length >= 0) {
+                if (n > (size_t)body_left) n = (size_t)body_left;
+                body_left -= (int32_t)n;
+                if (body_left == 0) state = DONE;
+            }
+            i += n;
+            continue;
+        }
+
+        char c = (char)data[i++];
+        if (c == '\n') {
+            if (line_len > 0 && line[line_len - 1] == '\r') line_len--;
+            on_line();
+            line_len = 0;
+        } else if (line_len < sizeof(line) - 1) {
+            line[line_len++] = c;
+        }
+    }
+    return i;
+}
+
+bool HttpResponseParser::on_close() {
+    keep_alive_ = false;
+    if (state == BODY && content_length < 0) state = DONE;
+    return done();
+}
@@ -0,0 +1,51 @@
+#ifndef HTTP_RESPONSE_PARSER_H_
+#define HTTP_RESPONSE_PARSER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Parser incremental de respuestas HTTP/1.x del lado cliente.
+//
+// Se alimenta con los trozos tal como llegan en las tramas +IPD; solo guarda
+// la línea en curso, no la respuesta. Del cuerpo no conserva nada: basta con
+// saber dónde termina para reutilizar la conexión.
+class HttpResponseParser {
+public:
+    HttpResponseParser() { reset(); }
+
+    void reset();
+
+    // Consume bytes hasta el final del mensaje. Devuelve cuántos usó; lo
+    // que sobre ya pertenece a la siguiente respuesta.
+    size_t feed(const uint8_t* data, size_t len);
+
+    // El servidor cerró la conexión. Una respuesta sin Content-Length
+    // termina aquí. Devuelve done().
+    bool on_close();
+
+    bool done() const { return state == DONE; }
+    bool failed() const { return state == FAILED; }
+    bool headers_done() const { return state == BODY || state == DONE; }
+
+    int  status() const { return status_code; }
+    bool success() const { return done() && status_code >= 200 && status_code < 300; }
+
+    // La conexión se puede reutilizar tras esta respuesta
+    bool keep_alive() const { return keep_alive_; }
+
+private:
+    enum State : uint8_t { STATUS_LINE, HEADERS, BODY, DONE, FAILED };
+
+    void on_line();
+    void end_of_headers();
+
+    State state;
+    char line[96];          // línea en curso (se trunca si es más larga)
+    size_t line_len;
+    int status_code;
+    int32_t content_length; // -1 si no vino
+    int32_t body_left;
+    bool keep_alive_;
+};
+
+#endif // HTTP_RESPONSE_PARSER_H_
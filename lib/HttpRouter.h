@@ -0,0 +1,98 @@
+#ifndef HTTP_ROUTER_H_
+#define HTTP_ROUTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "HttpRequest.h"
+
+// Tabla de rutas resuelta en compilación.
+//
+// Cada ruta es (métodos admitidos, ruta exacta, manejador). make_route_table()
+// busca en compilación una semilla con la que el hash de todas las rutas cae
+// en huecos distintos (hash perfecto), así que find() cuesta un hash de la
+// ruta pedida y una sola comparación, sin importar cuántas rutas haya.
+// Añadir una ruta es añadir una línea a la tabla; si dos rutas chocan para
+// todas las semillas, la compilación falla en el static_assert de valid().
+
+namespace http {
+
+constexpr uint16_t method_bit(HttpRequest::Method m) { return (uint16_t)(1u << m); }
+
+template <typename Handler>
+struct Route {
+    uint16_t methods;           // máscara de method_bit()
+    std::string_view path;
+    Handler handler;
+};
+
+// FNV-1a con semilla
+constexpr uint32_t route_hash(std::string_view s, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : s) {
+        h ^= (uint8_t)c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+constexpr size_t route_slots(size_t n) {
+    size_t s = 1;
+    while (s < 2 * n) s <<= 1;
+    return s;
+}
+
+template <typename Handler, size_t N, size_t SLOTS = route_slots(N)>
+class RouteTable {
+    static_assert((SLOTS & (SLOTS - 1)) == 0, "SLOTS debe ser potencia de dos");
+    static_assert(N < 0xFF, "demasiadas rutas");
+
+public:
+    static const uint32_t MAX_SEED = 4096;
+
+    constexpr explicit RouteTable(const Route<Handler> (&r)[N]) {
+        for (size_t i = 0; i < N; i++) routes[i] = r[i];
+        for (uint32_t s = 1; s <= MAX_SEED && seed == 0; s++) {
+            if (try_seed(s)) seed = s;
+        }
+    }
+
+    // Semilla encontrada: todas las rutas en huecos distintos
+    constexpr bool valid() const { return seed != 0; }
+
+    // Ruta con ese path exacto, o nullptr
+    const Route<Handler>* find(std::string_view path) const {
+        uint8_t i = slots[route_hash(path, seed) & (SLOTS - 1)];
+        if (i == EMPTY || routes[i].path != path) return nullptr;
+        return &routes[i];
+    }
+
+    static constexpr size_t size() { return N; }
+    const Route<Handler>& at(size_t i) const { return routes[i]; }
+
+private:
+    static const uint8_t EMPTY = 0xFF;
+
+    constexpr bool try_seed(uint32_t s) {
+        for (size_t k = 0; k < SLOTS; k++) slots[k] = EMPTY;
+        for (size_t i = 0; i < N; i++) {
+            size_t k = route_hash(routes[i].path, s) & (SLOTS - 1);
+            if (slots[k] != EMPTY) return false;
+            slots[k] = (uint8_t)i;
+        }
+        return true;
+    }
+
+    Route<Handler> routes[N] = {};
+    uint8_t slots[SLOTS] = {};
+    uint32_t seed = 0;
+};
+
+template <typename Handler, size_t N>
+constexpr RouteTable<Handler, N> make_route_table(const Route<Handler> (&r)[N]) {
+    return RouteTable<Handler, N>(r);
+}
+
+} // namespace http
+
+#endif // HTTP_ROUTER_H_
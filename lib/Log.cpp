@@ -0,0 +1,177 @@
+#include "Log.h"
+#include "pico/stdlib.h"
+#include <cstdio>
+
+static_assert(cfg::LOG_LEVEL >= Log::OFF && cfg::LOG_LEVEL <= Log::DEBUG, "LOG_LEVEL fuera de rango");
+
+SpscQueue<Log::Record, cfg::LOG_RING_RECORDS> Log::rings[2];
+
+uint8_t Log::levels[NUM_MODULES] = {
+    cfg::LOG_LEVEL, cfg::LOG_LEVEL, cfg::LOG_LEVEL, cfg::LOG_LEVEL,
+    cfg::LOG_LEVEL, cfg::LOG_LEVEL, cfg::LOG_TO_USB ? DEBUG : OFF,
+};
+bool Log::deferred = false;
+uint32_t Log::total_printed = 0;
+uint32_t Log::reported_dropped = 0;
+
+// Línea formateada más larga; lo que no quepa se corta
+static const size_t LINE_MAX = 192;
+
+const char* Log::module_name(Module m) {
+    static const char* const kNames[NUM_MODULES] = {
+        "MPU6050", "SeismicMonitor", "Capture", "HTTP", "HTTPC", "API", "ESP",
+    };
+    return m < NUM_MODULES ? kNames[m] : "?";
+}
+
+void Log::submit(Record& r) {
+    r.t_us = time_us_32();
+    if (!deferred) {
+        print(r);
+        return;
+    }
+    rings[get_core_num() & 1].push(r);
+}
+
+void Log::raw(Module m, Level l, const char* data, size_t len) {
+    if (!enabled(m, l)) return;
+    while (len > 0) {
+        Record r;
+        size_t n = len < RAW_BYTES ? len : RAW_BYTES;
+        r.fmt = nullptr;
+        r.module = m;
+        r.level = l;
+        r.nargs = (uint8_t)n;
+        memcpy(r.args, data, n);
+        submit(r);
+        data += n;
+        len -= n;
+    }
+}
+
+int Log::drain(uint32_t budget_us) {
+    uint32_t start = time_us_32();
+    int n = 0;
+
+    uint32_t lost = dropped();
+    if (lost != reported_dropped) {
+        printf("[LOG] %lu registros perdidos (anillo lleno)\n", (unsigned long)(lost - reported_dropped));
+        reported_dropped = lost;
+    }
+
+    do {
+        // El más antiguo de los dos anillos
+        Record a, b;
+        bool has_a = rings[0].peek(a);
+        bool has_b = rings[1].peek(b);
+        if (!has_a && !has_b) break;
+        bool take_a = has_a && (!has_b || (int32_t)(a.t_us - b.t_us) <= 0);
+        rings[take_a ? 0 : 1].pop(take_a ? a : b);
+        print(take_a ? a : b);
+        n++;
+        total_printed++;
+    } while (time_us_32() - start < budget_us);
+    return n;
+}
+
+uint32_t Log::pending() {
+    return rings[0].size() + rings[1].size();
+}
+
+uint32_t Log::dropped() {
+    return rings[0].dropped_count() + rings[1].dropped_count();
+}
+
+void Log::print(const Record& r) {
+    if (!r.fmt) {
+        fwrite(r.args, 1, r.nargs, stdout);
+        return;
+    }
+    char line[LINE_MAX];
+    size_t n = format(r, line, sizeof(line));
+    // Una línea cortada conserva su salto
+    const char* nl = (n > 0 && line[n - 1] == '\n') ? "" : "\n";
+    printf("[%s] %s%s", module_name((Module)r.module), line, nl);
+}
+
+// snprintf de una sola conversión con sus '*' de ancho/precisión delante
+template <typename T>
+static int put(char* out, size_t size, const char* spec, int stars, const int* star, T v) {
+    switch (stars) {
+    case 0:  return snprintf(out, size, spec, v);
+    case 1:  return snprintf(out, size, spec, star[0], v);
+    default: return snprintf(out, size, spec, star[0], star[1], v);
+    }
+}
+
+// Recorre la cadena de formato y pasa cada argumento guardado a snprintf con
+// el tipo que pide su conversión
+size_t Log::format(const Record& r, char* out, size_t size) {
+    size_t n = 0;
+    int a = 0;
+    auto next = [&]() -> Word { return a < r.nargs ? r.args[a++] : 0; };
+
+    for (const char* p = r.fmt; *p && n + 1 < size;) {
+        if (*p != '%') {
+            out[n++] = *p++;
+            continue;
+        }
+
+        char spec[16];
+        size_t k = 0;
+        int stars = 0;
+        bool is_long = false, is_size = false;
+        spec[k++] = *p++;
+        while (*p && !strchr("diouxXcspfFeEgGaA%", *p)) {
+            if (*p == '*') stars++;
+            if (*p == 'l') is_long = true;
+            if (*p == 'z') is_size = true;
+            if (k < sizeof(spec) - 2) spec[k++] = *p;
+            p++;
+        }
+        if (!*p) break;
+        char conv = *p++;
+        spec[k++] = conv;
+        spec[k] = '\0';
+        if (conv == '%') {
+            out[n++] = '%';
+            continue;
+        }
+
+        int star[2] = {0, 0};
+        for (int s = 0; s < stars && s < 2; s++) star[s] = (int)(int32_t)next();
+        Word w = next();
+        char* dst = out + n;
+        size_t room = size - n;
+        int len;
+        switch (conv) {
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            uint32_t u = (uint32_t)w;
+            float f;
+            memcpy(&f, &u, sizeof(f));
+            len = put(dst, room, spec, stars, star, (double)f);
+            break;
+        }
+        case 's':
+            len = put(dst, room, spec, stars, star, w ? (const char*)w : "(null)");
+            break;
+        case 'p':
+            len = put(dst, room, spec, stars, star, (void*)w);
+            break;
+        case 'd': case 'i':
+            if (is_size)      len = put(dst, room, spec, stars, star, (size_t)w);
+            else if (is_long) len = put(dst, room, spec, stars, star, (long)(intptr_t)w);
+            else              len = put(dst, room, spec, stars, star, (int)(int32_t)w);
+            break;
+        default:    // o u x X c
+            if (is_size)      len = put(dst, room, spec, stars, star, (size_t)w);
+            else if (is_long) len = put(dst, room, spec, stars, star, (unsigned long)w);
+            else              len = put(dst, room, spec, stars, star, (unsigned)w);
+            break;
+        }
+        if (len < 0) break;
+        n += (size_t)len < room ? (size_t)len : room - 1;
+    }
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,119 @@
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "../Config.h"
+#include "SpscQueue.h"
+
+// Log diferido por niveles y módulos.
+//
+// En los caminos calientes un printf por USB puede bloquear (el CDC se llena
+// si el host no lee). Aquí el productor solo guarda un registro binario en
+// un anillo en RAM: puntero a la cadena de formato, marca de tiempo y los
+// argumentos crudos (enteros, float, punteros). El texto se forma después,
+// en drain(), desde la tarea de menor prioridad del planificador.
+//
+// Reglas para los argumentos: como mucho MAX_ARGS, enteros de hasta 32 bits,
+// float/double (se guardan como float) y cadenas %s que vivan siempre
+// (literales, nombres de tabla): el registro guarda el puntero, no el texto.
+//
+// Hay un anillo por core, así cada uno es de un solo productor; drain()
+// los mezcla por orden de llegada. No se llama desde interrupciones.
+class Log {
+public:
+    enum Level : uint8_t { OFF, ERROR, WARN, INFO, DEBUG };
+
+    // El nombre de cada módulo es el prefijo de sus líneas ("[HTTP] ...")
+    enum Module : uint8_t { MPU, MONITOR, CAPTURE, HTTP, HTTPC, API, ESP, NUM_MODULES };
+
+    static const int MAX_ARGS = 8;
+    using Word = uintptr_t;
+
+    static void set_level(Module m, Level l) { levels[m] = l; }
+    static Level level(Module m) { return (Level)levels[m]; }
+    static bool enabled(Module m, Level l) { return l != OFF && l <= levels[m]; }
+    static const char* module_name(Module m);
+
+    // Con deferred == false (arranque, antes del planificador) cada registro
+    // se imprime en el acto
+    static void set_deferred(bool on) { deferred = on; }
+
+    template <typename... Args>
+    static void write(Module m, Level l, const char* fmt, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "demasiados argumentos para un registro");
+        if (!enabled(m, l)) return;
+        Record r;
+        r.fmt = fmt;
+        r.module = m;
+        r.level = l;
+        r.nargs = (uint8_t)sizeof...(Args);
+        int i = 0;
+        ((r.args[i++] = word(args)), ...);
+        (void)i;
+        submit(r);
+    }
+
+    template <typename... Args>
+    static void error(Module m, const char* fmt, Args... args) { write(m, ERROR, fmt, args...); }
+    template <typename... Args>
+    static void warn(Module m, const char* fmt, Args... args) { write(m, WARN, fmt, args...); }
+    template <typename... Args>
+    static void info(Module m, const char* fmt, Args... args) { write(m, INFO, fmt, args...); }
+    template <typename... Args>
+    static void debug(Module m, const char* fmt, Args... args) { write(m, DEBUG, fmt, args...); }
+
+    // Bytes tal cual (eco del tráfico con el ESP), sin prefijo ni salto de
+    // línea. Se trocean en registros de RAW_BYTES.
+    static void raw(Module m, Level l, const char* data, size_t len);
+    static const size_t RAW_BYTES = MAX_ARGS * sizeof(Word);
+
+    // Formatea e imprime registros hasta vaciar los anillos o agotar
+    // budget_us. Devuelve cuántos imprimió.
+    static int drain(uint32_t budget_us);
+
+    static uint32_t pending();
+    static uint32_t dropped();      // registros perdidos con el anillo lleno
+    static uint32_t printed() { return total_printed; }
+
+private:
+    struct Record {
+        uint32_t t_us;
+        const char* fmt;            // nullptr: bytes crudos en args
+        uint8_t module;
+        uint8_t level;
+        uint8_t nargs;              // con fmt == nullptr, número de bytes
+        Word args[MAX_ARGS];
+    };
+
+    template <typename T>
+    static Word word(T v) {
+        if constexpr (std::is_floating_point_v<T>) {
+            float f = (float)v;
+            uint32_t u;
+            memcpy(&u, &f, sizeof(u));
+            return u;
+        } else if constexpr (std::is_pointer_v<T>) {
+            return (Word)v;
+        } else {
+            static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "tipo no admitido en el log");
+            static_assert(sizeof(T) <= sizeof(Word), "entero demasiado ancho para el log");
+            return (Word)v;
+        }
+    }
+
+    static void submit(Record& r);
+    static void print(const Record& r);
+    static size_t format(const Record& r, char* out, size_t size);
+
+    // Un anillo por core: core0 (planificador) y core1 (adquisición)
+    static SpscQueue<Record, cfg::LOG_RING_RECORDS> rings[2];
+    static uint8_t levels[NUM_MODULES];
+    static bool deferred;
+    static uint32_t total_printed;
+    static uint32_t reported_dropped;
+};
+
+#endif // LOG_H_
@@ -1,9 +1,14 @@
 #include "MPU6050.h"
 #include "../Config.h"
+#include "Metrics.h"
 #include <cstdio>
 
+MPU6050* MPU6050::irq_instance = nullptr;
+
 MPU6050::MPU6050(i2c_inst_t* i2c_instance, uint8_t addr) 
-    : i2c(i2c_instance), address(addr), accel_offset_x(0), accel_offset_y(0), accel_offset_z(0) {
+    : i2c(i2c_instance), address(addr), accel_offset_x(0), accel_offset_y(0), accel_offset_z(0),
+      fifo_enabled(false), sample_period_us(0), fifo_overflows(0),
+      irq_missed(0), irq_enabled(false) {
 }
 
 int MPU6050::write_register(uint8_t reg, uint8_t value) {
@@ -61,38 +66,34 @@ bool MPU6050::test_connection() {
 bool MPU6050::calibrate(int samples) {
     printf("[MPU6050] Iniciando calibración con %d muestras...\n", samples);
     
-    float sum_x = 0, sum_y = 0, sum_z = 0;
+    int32_t sum_x = 0, sum_y = 0, sum_z = 0;
     int valid_samples = 0;
     
     for (int i = 0; i < samples; i++) {
         int16_t ax, ay, az, gx, gy, gz;
         
         if (read_raw_data(&ax, &ay, &az, &gx, &gy, &gz)) {
-            // Convertir a g's y luego a m/s²
-            float accel_x = (float)ax / cfg::ACCEL_SCALE_FACTOR * cfg::GRAVITY;
-            float accel_y = (float)ay / cfg::ACCEL_SCALE_FACTOR * cfg::GRAVITY;
-            float accel_z = (float)az / cfg::ACCEL_SCALE_FACTOR * cfg::GRAVITY;
-            
-            sum_x += accel_x;
-            sum_y += accel_y;
-            sum_z += accel_z - cfg::GRAVITY; // Compensar gravedad en Z
+            sum_x += ax;
+            sum_y += ay;
+            sum_z += az - fx::ACCEL_COUNTS_PER_G; // Compensar gravedad en Z
             valid_samples++;
         }
         
         sleep_ms(10);
     }
     
-    if (valid_samples < samples * 0.8) { // Al menos 80% de muestras válidas
+    if (valid_samples * 5 < samples * 4) { // Al menos 80% de muestras válidas
         printf("[MPU6050] Error: No se obtuvieron suficientes muestras válidas\n");
         return false;
     }
     
-    accel_offset_x = sum_x / valid_samples;
-    accel_offset_y = sum_y / valid_samples;
-    accel_offset_z = sum_z / valid_samples;
+    accel_offset_x = fx::clamp_i16(sum_x / valid_samples);
+    accel_offset_y = fx::clamp_i16(sum_y / valid_samples);
+    accel_offset_z = fx::clamp_i16(sum_z / valid_samples);
     
     printf("[MPU6050] Calibración completada. Offsets: X=%.3f, Y=%.3f, Z=%.3f m/s²\n",
-           accel_offset_x, accel_offset_y, accel_offset_z);
+           fx::accel_to_mps2(accel_offset_x), fx::accel_to_mps2(accel_offset_y),
+           fx::accel_to_mps2(accel_offset_z));
     
     return true;
 }
@@ -118,6 +119,24 @@ bool MPU6050::read_raw_data(int16_t* accel_x, int16_t* accel_y, int16_t* accel_z
     return true;
 }
 
+void MPU6050::convert_raw(int16_t ax, int16_t ay, int16_t az,
+                          int16_t gx, int16_t gy, int16_t gz, SensorData& data) const {
+    // Acelerómetro: quitar offsets de calibración, todo en cuentas
+    data.accel_x = fx::clamp_i16((int32_t)ax - accel_offset_x);
+    data.accel_y = fx::clamp_i16((int32_t)ay - accel_offset_y);
+    data.accel_z = fx::clamp_i16((int32_t)az - accel_offset_z);
+    
+    // Giroscopio en cuentas crudas (131 = 1 °/s)
+    data.gyro_x = gx;
+    data.gyro_y = gy;
+    data.gyro_z = gz;
+    
+    // Magnitud: |a|² entero para comparar con umbrales pre-elevados y
+    // raíz entera para estadísticas
+    data.magnitude_sq = fx::magnitude_sq(data.accel_x, data.accel_y, data.accel_z);
+    data.magnitude = (uint16_t)fx::isqrt32(data.magnitude_sq);
+}
+
 bool MPU6050::read_sensor_data(SensorData& data) {
     int16_t ax, ay, az, gx, gy, gz;
     
@@ -125,36 +144,151 @@ bool MPU6050::read_sensor_data(SensorData& data) {
         return false;
     }
     
-    // Convertir acelerómetro a m/s² y aplicar calibración
-    data.accel_x = ((float)ax / cfg::ACCEL_SCALE_FACTOR * cfg::GRAVITY) - accel_offset_x;
-    data.accel_y = ((float)ay / cfg::ACCEL_SCALE_FACTOR * cfg::GRAVITY) - accel_offset_y;
-    data.accel_z = ((float)az / cfg::ACCEL_SCALE_FACTOR * cfg::GRAVITY) - accel_offset_z;
+    convert_raw(ax, ay, az, gx, gy, gz, data);
     
-    // Convertir giroscopio a °/s (escala por defecto ±250°/s)
-    const float gyro_scale = 131.0f; // LSB/°/s para rango ±250°/s
-    data.gyro_x = (float)gx / gyro_scale;
-    data.gyro_y = (float)gy / gyro_scale;
-    data.gyro_z = (float)gz / gyro_scale;
+    // Timestamp
+    data.timestamp_us = time_us_64();
+    data.timestamp = data.timestamp_us / 1000u;
     
-    // Calcular magnitud vectorial de aceleración
-    data.magnitude = sqrt(data.accel_x * data.accel_x + 
-                         data.accel_y * data.accel_y + 
-                         data.accel_z * data.accel_z);
+    return true;
+}
+
+bool MPU6050::init_fifo(uint16_t sample_rate_hz) {
+    // Con el DLPF activo el muestreo interno es 1 kHz:
+    // Fs = 1000 / (1 + SMPLRT_DIV)
+    if (sample_rate_hz == 0 || sample_rate_hz > 1000) return false;
+    uint8_t div = (uint8_t)(1000 / sample_rate_hz - 1);
+    sample_period_us = 1000u * (1u + div);
     
-    // Timestamp
-    data.timestamp = to_ms_since_boot(get_absolute_time());
+    if (write_register(MPU6050_CONFIG, MPU6050_DLPF_44HZ) < 0 ||
+        write_register(MPU6050_SMPLRT_DIV, div) < 0 ||
+        write_register(MPU6050_FIFO_EN, MPU6050_FIFO_EN_ACCEL_GYRO) < 0) {
+        printf("[MPU6050] Error: No se pudo configurar la FIFO\n");
+        return false;
+    }
     
+    reset_fifo();
+    fifo_enabled = true;
+    printf("[MPU6050] FIFO activa: %u Hz (SMPLRT_DIV=%u)\n",
+           (unsigned)(1000000u / sample_period_us), (unsigned)div);
     return true;
 }
 
-bool MPU6050::is_significant_movement(const SensorData& data, float threshold) {
-    return data.magnitude > threshold;
+void MPU6050::reset_fifo() {
+    write_register(MPU6050_USER_CTRL, MPU6050_USER_CTRL_FIFO_RST);
+    write_register(MPU6050_USER_CTRL, MPU6050_USER_CTRL_FIFO_EN);
+    
+    // Los instantes anotados ya no corresponden a ninguna trama
+    uint64_t stale;
+    while (irq_stamps.pop(stale)) {}
+}
+
+bool MPU6050::enable_data_ready_irq(int gpio_pin) {
+    if (gpio_pin < 0) return false;
+    
+    // INT activo en alto, push-pull, pulso de 50 µs
+    if (write_register(MPU6050_INT_PIN_CFG, 0x00) < 0 ||
+        write_register(MPU6050_INT_ENABLE, MPU6050_INT_DATA_RDY_EN) < 0) {
+        printf("[MPU6050] Error: No se pudo activar DATA_RDY\n");
+        return false;
+    }
+    
+    irq_instance = this;
+    gpio_init(gpio_pin);
+    gpio_set_dir(gpio_pin, GPIO_IN);
+    gpio_pull_down(gpio_pin);
+    gpio_set_irq_enabled_with_callback(gpio_pin, GPIO_IRQ_EDGE_RISE, true, gpio_irq_handler);
+    irq_enabled = true;
+    
+    // Alinear FIFO e instantes desde cero
+    if (fifo_enabled) reset_fifo();
+    
+    printf("[MPU6050] Interrupción DATA_RDY en GP%d\n", gpio_pin);
+    return true;
+}
+
+void MPU6050::gpio_irq_handler(uint gpio, uint32_t events) {
+    (void)gpio;
+    (void)events;
+    uint64_t now = time_us_64();
+    MPU6050* self = irq_instance;
+    if (!self) return;
+    if (!self->irq_stamps.push(now)) self->irq_missed = self->irq_missed + 1;
+    __sev();
+}
+
+int MPU6050::read_fifo_batch(SensorData* out, int max_samples) {
+    if (!fifo_enabled) return -1;
+    
+    uint32_t i2c_start = time_us_32();
+    uint8_t count_buf[2];
+    if (read_registers(MPU6050_FIFO_COUNTH, count_buf, 2) < 0) {
+        Metrics::count(Metrics::I2C_ERRORS);
+        return -1;
+    }
+    uint64_t now_us = time_us_64();
+    uint16_t count = (uint16_t)((count_buf[0] << 8) | count_buf[1]);
+    
+    // FIFO llena o desalineada: se perdieron muestras, reiniciar
+    if (count >= MPU6050_FIFO_SIZE - MPU6050_FIFO_FRAME_BYTES ||
+        count % MPU6050_FIFO_FRAME_BYTES != 0) {
+        fifo_overflows++;
+        reset_fifo();
+        return 0;
+    }
+    
+    int available = count / MPU6050_FIFO_FRAME_BYTES;
+    int n = available;
+    if (n > max_samples) n = max_samples;
+    if (n > cfg::FIFO_BATCH_MAX) n = cfg::FIFO_BATCH_MAX;
+    if (n == 0) return 0;
+    
+    // Una sola ráfaga I2C para todo el lote
+    if (read_registers(MPU6050_FIFO_R_W, fifo_buffer, (size_t)n * MPU6050_FIFO_FRAME_BYTES) < 0) {
+        Metrics::count(Metrics::I2C_ERRORS);
+        return -1;
+    }
+    Metrics::record(Metrics::I2C_READ, time_us_32() - i2c_start);
+    Metrics::Scope convert_timer(Metrics::CONVERT);
+    
+    // Tramas sin instante de la ISR (interrupción perdida o aún sin activar):
+    // son las más antiguas del lote y se extrapolan desde la primera anotada.
+    int unstamped = irq_enabled ? available - (int)irq_stamps.size() : available;
+    if (unstamped < 0) unstamped = 0;
+    
+    for (int i = 0; i < n; i++) {
+        const uint8_t* f = &fifo_buffer[i * MPU6050_FIFO_FRAME_BYTES];
+        // Orden de la FIFO: ACCEL_XYZ, GYRO_XYZ (sin temperatura)
+        convert_raw((int16_t)((f[0] << 8) | f[1]), (int16_t)((f[2] << 8) | f[3]),
+                    (int16_t)((f[4] << 8) | f[5]), (int16_t)((f[6] << 8) | f[7]),
+                    (int16_t)((f[8] << 8) | f[9]), (int16_t)((f[10] << 8) | f[11]), out[i]);
+        
+        uint64_t t_us;
+        uint64_t anchor;
+        if (i >= unstamped && irq_stamps.pop(t_us)) {
+            // Instante real capturado por la ISR
+        } else if (i < unstamped && irq_stamps.peek(anchor)) {
+            t_us = anchor - (uint64_t)(unstamped - i) * sample_period_us;
+        } else {
+            // Sin ISR: la muestra más reciente se tomó como mucho un periodo
+            // antes de leer FIFO_COUNT; las anteriores, un periodo más cada una.
+            t_us = now_us - (uint64_t)(available - 1 - i) * sample_period_us;
+        }
+        out[i].timestamp_us = t_us;
+        out[i].timestamp = t_us / 1000u;
+    }
+    
+    return n;
+}
+
+bool MPU6050::is_significant_movement(const SensorData& data, uint32_t threshold_sq) {
+    return data.magnitude_sq > threshold_sq;
 }
 
-const char* MPU6050::get_event_type(float magnitude) {
-    if (magnitude >= cfg::EARTHQUAKE_THRESHOLD) {
+const char* MPU6050::get_event_type(uint32_t magnitude_sq) {
+    if (magnitude_sq >= fx::EARTHQUAKE_THRESHOLD_SQ) {
         return "earthquake";
-    } else if (magnitude >= cfg::VIBRATION_THRESHOLD) {
+    } else if (magnitude_sq >= fx::VIBRATION_THRESHOLD_SQ) {
         return "vibration";
     } else {
         return "normal";
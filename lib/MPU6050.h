@@ -3,9 +3,19 @@
 
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
-#include <cmath>
+#include "../Config.h"
+#include "FixedPoint.h"
+#include "SpscQueue.h"
 
 // Registros del MPU6050
+#define MPU6050_SMPLRT_DIV    0x19
+#define MPU6050_CONFIG        0x1A
+#define MPU6050_FIFO_EN       0x23
+#define MPU6050_INT_PIN_CFG   0x37
+#define MPU6050_INT_ENABLE    0x38
+#define MPU6050_USER_CTRL     0x6A
+#define MPU6050_FIFO_COUNTH   0x72
+#define MPU6050_FIFO_R_W      0x74
 #define MPU6050_PWR_MGMT_1    0x6B
 #define MPU6050_PWR_MGMT_2    0x6C
 #define MPU6050_ACCEL_CONFIG  0x1C
@@ -23,22 +33,54 @@
 #define MPU6050_GYRO_ZOUT_L   0x48
 #define MPU6050_WHO_AM_I      0x75
 
+// Bits de configuración de la FIFO
+#define MPU6050_FIFO_EN_ACCEL_GYRO  0x78  // XG|YG|ZG|ACCEL -> 12 bytes por muestra
+#define MPU6050_USER_CTRL_FIFO_EN   0x40
+#define MPU6050_USER_CTRL_FIFO_RST  0x04
+#define MPU6050_FIFO_SIZE           1024
+#define MPU6050_FIFO_FRAME_BYTES    12
+#define MPU6050_DLPF_44HZ           0x03  // ancho de banda ~44 Hz, muestreo interno 1 kHz
+#define MPU6050_INT_DATA_RDY_EN     0x01
+
+// Muestra en cuentas del sensor (ver FixedPoint.h). Para pasar a m/s² o
+// °/s usar fx::accel_to_mps2() / fx::gyro_to_dps() al formatear.
 struct SensorData {
-    float accel_x;    // m/s²
-    float accel_y;    // m/s²
-    float accel_z;    // m/s²
-    float gyro_x;     // °/s
-    float gyro_y;     // °/s
-    float gyro_z;     // °/s
-    float magnitude;  // magnitud vectorial de aceleración
+    int16_t accel_x;  // cuentas con calibración aplicada (16384 = 1 g)
+    int16_t accel_y;
+    int16_t accel_z;
+    int16_t gyro_x;   // cuentas (131 = 1 °/s)
+    int16_t gyro_y;
+    int16_t gyro_z;
+    uint32_t magnitude_sq; // |a|² en cuentas²
+    uint16_t magnitude;    // |a| en cuentas (raíz entera)
     uint64_t timestamp; // timestamp en ms
+    uint64_t timestamp_us; // instante de muestreo en µs (capturado en la ISR de INT)
 };
 
 class MPU6050 {
 private:
     i2c_inst_t* i2c;
     uint8_t address;
-    float accel_offset_x, accel_offset_y, accel_offset_z;
+    int16_t accel_offset_x, accel_offset_y, accel_offset_z;  // cuentas
+    
+    // FIFO
+    bool fifo_enabled;
+    uint32_t sample_period_us;
+    uint32_t fifo_overflows;
+    uint8_t fifo_buffer[cfg::FIFO_BATCH_MAX * MPU6050_FIFO_FRAME_BYTES];
+    
+    // Convertir una muestra cruda a unidades físicas
+    void convert_raw(int16_t ax, int16_t ay, int16_t az,
+                     int16_t gx, int16_t gy, int16_t gz, SensorData& data) const;
+    void reset_fifo();
+    
+    // Interrupción DATA_RDY: la ISR solo anota el instante de cada muestra
+    // (1:1 con las tramas de la FIFO) y avisa al bucle de adquisición.
+    SpscQueue<uint64_t, 128> irq_stamps;
+    volatile uint32_t irq_missed;
+    bool irq_enabled;
+    static MPU6050* irq_instance;
+    static void gpio_irq_handler(uint gpio, uint32_t events);
     
     // Escribir un registro
     int write_register(uint8_t reg, uint8_t value);
@@ -65,11 +107,32 @@ public:
     // Leer datos procesados
     bool read_sensor_data(SensorData& data);
     
-    // Verificar si hay movimiento significativo
-    bool is_significant_movement(const SensorData& data, float threshold);
+    // Configurar muestreo por hardware (SMPLRT_DIV + DLPF) y la FIFO
+    // con acelerómetro y giroscopio.
+    bool init_fifo(uint16_t sample_rate_hz);
+    
+    // Vaciar la FIFO en ráfaga: una sola transacción I2C para hasta
+    // max_samples muestras, de la más antigua a la más reciente, con
+    // timestamp reconstruido a partir del periodo de muestreo.
+    // Devuelve el número de muestras leídas o -1 si hubo error.
+    int read_fifo_batch(SensorData* out, int max_samples);
+    
+    uint32_t get_fifo_overflows() const { return fifo_overflows; }
+    
+    // Activar DATA_RDY en el pin INT del sensor. La ISR queda instalada en
+    // el núcleo que llama, que debe ser el que hace la adquisición.
+    bool enable_data_ready_irq(int gpio_pin);
+    
+    // Muestras anunciadas por la ISR aún sin leer de la FIFO.
+    uint32_t samples_pending() const { return irq_stamps.size(); }
+    uint32_t get_irq_missed() const { return irq_missed + irq_stamps.dropped_count(); }
+    bool has_data_ready_irq() const { return irq_enabled; }
+    
+    // Verificar si hay movimiento significativo (umbral en cuentas², ver fx::)
+    bool is_significant_movement(const SensorData& data, uint32_t threshold_sq);
     
-    // Obtener tipo de evento basado en la magnitud
-    const char* get_event_type(float magnitude);
+    // Obtener tipo de evento basado en |a|² (cuentas²)
+    const char* get_event_type(uint32_t magnitude_sq);
     
     // Test de conectividad
     bool test_connection();
@@ -0,0 +1,63 @@
+#include "Metrics.h"
+#include <cstdio>
+
+Metrics::Histogram Metrics::timers[NUM_TIMERS];
+volatile uint32_t Metrics::counters[NUM_COUNTERS];
+
+const char* Metrics::timer_name(Timer t) {
+    static const char* const kNames[NUM_TIMERS] = {
+        "i2c_read", "convert", "filter", "detect", "process", "json",
+        "http_dispatch", "at_round_trip", "cipsend_prompt", "cipsend_data",
+    };
+    return t < NUM_TIMERS ? kNames[t] : "?";
+}
+
+const char* Metrics::counter_name(Counter c) {
+    static const char* const kNames[NUM_COUNTERS] = {
+        "samples", "i2c_errors", "at_commands", "at_errors", "tx_bytes", "http_requests",
+    };
+    return c < NUM_COUNTERS ? kNames[c] : "?";
+}
+
+uint32_t Metrics::bucket_limit_us(int b) {
+    return b < NUM_BUCKETS - 1 ? 16u << (2 * b) : 0;
+}
+
+void Metrics::record(Timer t, uint32_t elapsed_us) {
+    Histogram& h = timers[t];
+    // Cubetas en potencias de 4 desde 16 us: sin divisiones
+    int b = 0;
+    for (uint32_t v = elapsed_us >> 4; v != 0 && b < NUM_BUCKETS - 1; v >>= 2) b++;
+    h.buckets[b]++;
+    h.count++;
+    h.total_us += elapsed_us;
+    if (elapsed_us > h.max_us) h.max_us = elapsed_us;
+}
+
+int Metrics::format_json(char* out, size_t size) {
+    size_t n = 0;
+    // Añade con snprintf y corta en cuanto no quepa
+    auto put = [&](const char* fmt, auto... args) {
+        if (n >= size) return;
+        int w = std::snprintf(out + n, size - n, fmt, args...);
+        n = w < 0 ? size : n + (size_t)w;
+    };
+
+    put("{\"uptime_ms\":%lu,\"buckets_us\":[", (unsigned long)to_ms_since_boot(get_absolute_time()));
+    for (int b = 0; b < NUM_BUCKETS - 1; b++) put("%s%lu", b ? "," : "", (unsigned long)bucket_limit_us(b));
+    put("%s", "],\"timers\":{");
+    for (int t = 0; t < NUM_TIMERS; t++) {
+        const Histogram& h = timers[t];
+        uint32_t avg = h.count ? (uint32_t)(h.total_us / h.count) : 0;
+        put("%s\"%s\":{\"n\":%lu,\"avg\":%lu,\"max\":%lu,\"h\":[", t ? "," : "", timer_name((Timer)t),
+            (unsigned long)h.count, (unsigned long)avg, (unsigned long)h.max_us);
+        for (int b = 0; b < NUM_BUCKETS; b++) put("%s%lu", b ? "," : "", (unsigned long)h.buckets[b]);
+        put("%s", "]}");
+    }
+    put("%s", "},\"counters\":{");
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        put("%s\"%s\":%lu", c ? "," : "", counter_name((Counter)c), (unsigned long)counters[c]);
+    }
+    put("%s", "}}");
+    return n < size ? (int)n : -1;
+}
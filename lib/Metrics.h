@@ -0,0 +1,86 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "pico/stdlib.h"
+
+// Instrumentación de los caminos calientes: temporizadores con nombre sobre
+// time_us_32() que acumulan un histograma de latencias de cubetas fijas, y
+// contadores. Todo en RAM estática; registrar cuesta dos lecturas del reloj
+// y unas sumas. Se publica en /api/metrics (format_json).
+//
+// Cada métrica la escribe un solo core (las del sensor, core1; las del
+// ESP, core0). El lector puede ver un histograma a medio actualizar, que
+// para vigilar tendencias da igual.
+class Metrics {
+public:
+    enum Timer : uint8_t {
+        I2C_READ,           // ráfaga I2C de la FIFO del MPU6050 (FIFO_COUNT + datos)
+        CONVERT,            // tramas crudas -> SensorData con marca de tiempo
+        FILTER,             // filtros por eje y |a| de una muestra
+        DETECT,             // STA/LTA y seguimiento del evento de una muestra
+        PROCESS,            // process_sample completo: coste total por muestra
+        JSON,               // formatear un evento o el estado para el API
+        HTTP_DISPATCH,      // analizar una petición y preparar su respuesta
+        AT_ROUND_TRIP,      // comando AT -> OK/ERROR
+        CIPSEND_PROMPT,     // AT+CIPSEND -> '>'
+        CIPSEND_DATA,       // datos -> SEND OK
+        NUM_TIMERS
+    };
+
+    enum Counter : uint8_t {
+        SAMPLES,            // muestras procesadas
+        I2C_ERRORS,         // lecturas de la FIFO fallidas
+        AT_COMMANDS,
+        AT_ERRORS,          // ERROR, FAIL, SEND FAIL
+        TX_BYTES,           // bytes de datos enviados con CIPSEND
+        HTTP_REQUESTS,
+        NUM_COUNTERS
+    };
+
+    // Cubetas: <16, <64, <256, <1024, <4096, <16384, <65536 us y el resto
+    static const int NUM_BUCKETS = 8;
+
+    struct Histogram {
+        uint32_t count;
+        uint32_t max_us;
+        uint64_t total_us;
+        uint32_t buckets[NUM_BUCKETS];
+    };
+
+    static void record(Timer t, uint32_t elapsed_us);
+    static void count(Counter c, uint32_t n = 1) { counters[c] = counters[c] + n; }
+
+    static const Histogram& timer(Timer t) { return timers[t]; }
+    static uint32_t counter(Counter c) { return counters[c]; }
+    static const char* timer_name(Timer t);
+    static const char* counter_name(Counter c);
+    // Límite superior (exclusivo) de la cubeta b; 0 para la última
+    static uint32_t bucket_limit_us(int b);
+
+    // {"uptime_ms":..,"buckets_us":[..],"timers":{"i2c_read":{"n":..,
+    // "avg":..,"max":..,"h":[..]},..},"counters":{..}}. Devuelve la longitud
+    // o -1 si no cabe.
+    static int format_json(char* out, size_t size);
+
+    // Temporizador con ámbito: mide desde la construcción hasta el final
+    // del bloque
+    class Scope {
+    public:
+        explicit Scope(Timer t) : timer_id(t), start_us(time_us_32()) {}
+        ~Scope() { record(timer_id, time_us_32() - start_us); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Timer timer_id;
+        uint32_t start_us;
+    };
+
+private:
+    static Histogram timers[NUM_TIMERS];
+    static volatile uint32_t counters[NUM_COUNTERS];
+};
+
+#endif // METRICS_H_
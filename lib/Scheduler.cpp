@@ -0,0 +1,79 @@
+#include "Scheduler.h"
+#include <cstdio>
+#include <cstring>
+
+Scheduler::Scheduler() : num_tasks(0) {
+    memset(tasks, 0, sizeof(tasks));
+}
+
+bool Scheduler::add_task(const char* name, PollFn fn, void* ctx,
+                         uint32_t period_us, uint32_t budget_us) {
+    if (num_tasks >= MAX_TASKS || fn == nullptr) {
+        printf("[SCHED] Error: no se pudo registrar la tarea '%s'\n", name);
+        return false;
+    }
+
+    Task& t = tasks[num_tasks++];
+    t.fn = fn;
+    t.ctx = ctx;
+    t.next_due_us = time_us_64();
+    t.stats.name = name;
+    t.stats.period_us = period_us;
+    t.stats.budget_us = budget_us;
+    return true;
+}
+
+void Scheduler::run_once() {
+    for (int i = 0; i < num_tasks; i++) {
+        Task& t = tasks[i];
+        uint64_t start = time_us_64();
+        if (start < t.next_due_us) continue;
+
+        // Una activación que llega más de un periodo tarde significa que
+        // alguna otra tarea nos robó un ciclo completo.
+        if (t.stats.period_us > 0 && start - t.next_due_us > t.stats.period_us) {
+            t.stats.late++;
+        }
+
+        t.fn(t.ctx, t.stats.budget_us);
+
+        uint32_t elapsed = (uint32_t)(time_us_64() - start);
+        t.stats.runs++;
+        t.stats.last_us = elapsed;
+        if (elapsed > t.stats.max_us) t.stats.max_us = elapsed;
+        if (elapsed > t.stats.budget_us) t.stats.overruns++;
+
+        // Mantener la cadencia sin acumular ráfagas de recuperación
+        t.next_due_us += t.stats.period_us;
+        if (t.next_due_us < start) t.next_due_us = start + t.stats.period_us;
+    }
+}
+
+[[noreturn]] void Scheduler::run() {
+    while (true) {
+        run_once();
+    }
+}
+
+void Scheduler::reset_stats() {
+    for (int i = 0; i < num_tasks; i++) {
+        TaskStats& s = tasks[i].stats;
+        s.runs = s.overruns = s.late = 0;
+        s.last_us = s.max_us = 0;
+    }
+}
+
+void Scheduler::print_stats() const {
+    printf("\n===== Planificador =====\n");
+    printf("%-10s %8s %8s %8s %6s %8s %8s\n",
+           "tarea", "periodo", "budget", "runs", "late", "overrun", "max_us");
+    for (int i = 0; i < num_tasks; i++) {
+        const TaskStats& s = tasks[i].stats;
+        printf("%-10s %8lu %8lu %8lu %6lu %8lu %8lu\n",
+               s.name,
+               (unsigned long)s.period_us, (unsigned long)s.budget_us,
+               (unsigned long)s.runs, (unsigned long)s.late,
+               (unsigned long)s.overruns, (unsigned long)s.max_us);
+    }
+    printf("========================\n\n");
+}
@@ -0,0 +1,60 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "pico/stdlib.h"
+#include <cstdint>
+
+// Planificador cooperativo de tareas.
+// Cada subsistema expone un paso poll() acotado y no bloqueante; el
+// planificador los intercala en un único bucle y mide cuánto tarda cada uno.
+class Scheduler {
+public:
+    // Paso de una tarea: ctx es el objeto dueño, budget_us el presupuesto
+    // de tiempo que la tarea debería respetar en esta llamada.
+    using PollFn = void (*)(void* ctx, uint32_t budget_us);
+
+    struct TaskStats {
+        const char* name;
+        uint32_t period_us;   // 0 = ejecutar en cada vuelta
+        uint32_t budget_us;
+        uint32_t runs;
+        uint32_t overruns;    // ejecuciones que superaron budget_us
+        uint32_t late;        // activaciones que llegaron más de un periodo tarde
+        uint32_t last_us;
+        uint32_t max_us;
+    };
+
+    static const int MAX_TASKS = 8;
+
+    Scheduler();
+
+    // Registrar una tarea. Devuelve false si no queda espacio.
+    bool add_task(const char* name, PollFn fn, void* ctx,
+                  uint32_t period_us, uint32_t budget_us);
+
+    // Una vuelta: ejecuta las tareas vencidas en orden de registro.
+    void run_once();
+
+    // Bucle principal. No retorna.
+    [[noreturn]] void run();
+
+    int task_count() const { return num_tasks; }
+    const TaskStats& stats(int index) const { return tasks[index].stats; }
+    void reset_stats();
+
+    // Debug
+    void print_stats() const;
+
+private:
+    struct Task {
+        PollFn fn;
+        void* ctx;
+        uint64_t next_due_us;
+        TaskStats stats;
+    };
+
+    Task tasks[MAX_TASKS];
+    int num_tasks;
+};
+
+#endif // SCHEDULER_H_
@@ -1,11 +1,32 @@
 #include "SeismicMonitor.h"
+#include "Log.h"
+#include "Metrics.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
 #include <cstdio>
 #include <cstring>
 
+SeismicMonitor* SeismicMonitor::core1_monitor = nullptr;
+
+// Contador de desbordes de la FIFO RX del UART del ESP
+static uint32_t uart_overruns(void* ctx) {
+    return static_cast<Esp8266HttpServer*>(ctx)->rx_ring().hw_overrun_count();
+}
+
 SeismicMonitor::SeismicMonitor(MPU6050* mpu_sensor, Esp8266HttpServer* http_server)
     : sensor(mpu_sensor), server(http_server), buffer_index(0), buffer_full(false),
-      last_sensor_read(0), last_api_send(0), last_status_send(0),
-      sensor_initialized(false), consecutive_errors(0) {
+      last_api_send(0), last_status_send(0),
+      sensor_initialized(false), consecutive_errors(0), reset_errors_requested(false),
+      calibration_requested(false),
+      detector(default_sta_lta_config()),
+      upload_record(nullptr), upload_offset(0), upload_failures(0), upload_chunk_samples(0),
+      journal(PICO_FLASH_SIZE_BYTES - cfg::JOURNAL_SECTORS * FlashJournal::SECTOR_SIZE, cfg::JOURNAL_SECTORS),
+      continuous_slot(nullptr), continuous_next_us(0), continuous_dropped(0),
+      upload_msg(nullptr), upload_handle(AsyncHttpClient::INVALID_HANDLE),
+      has_pending_event(false),
+      core1_max_jitter_us(0), core1_late(0) {
+    memset(journal_fed, 0, sizeof(journal_fed));
+    memset(journal_drained_at, 0xFF, sizeof(journal_drained_at));
 }
 
 bool SeismicMonitor::init() {
@@ -25,162 +46,559 @@ bool SeismicMonitor::init() {
         consecutive_errors = MAX_CONSECUTIVE_ERRORS / 2;
     }
     
+    // Muestreo por hardware a cfg::SAMPLE_RATE_HZ a través de la FIFO
+    if (!sensor->init_fifo(cfg::SAMPLE_RATE_HZ)) {
+        printf("[SeismicMonitor] Error: No se pudo activar la FIFO del sensor\n");
+        return false;
+    }
+    
+    // En modo doble núcleo la interrupción la activa core1
+    if (!cfg::DUAL_CORE) {
+        sensor->enable_data_ready_irq(cfg::MPU6050_INT_PIN);
+    }
+    
+    // Diario en flash: lo que quedó sin entregar antes del reinicio se
+    // reenvía. Sin diario, eventos y formas de onda se envían directamente.
+    // Los desbordes del UART durante sus borrados se le apuntan al diario.
+    if (server) journal.set_overrun_counter(uart_overruns, server);
+    if (!journal.begin()) {
+        printf("[SeismicMonitor] Advertencia: diario en flash no disponible\n");
+    } else {
+        // Los ids de evento siguen a la secuencia del diario para no repetir
+        // los de antes del reinicio que aún se reenvían: cada evento guarda
+        // al menos su inicio y su resumen, así que la secuencia avanza más
+        // deprisa que los ids
+        tracker.set_next_id(journal.next_sequence());
+    }
+    
+    // Jitter de los reintentos distinto en cada arranque
+    uplink.seed((uint32_t)to_us_since_boot(get_absolute_time()));
+    
     sensor_initialized = true;
     
     printf("[SeismicMonitor] Inicialización completada\n");
     return true;
 }
 
-void SeismicMonitor::loop() {
-    uint64_t current_time = to_ms_since_boot(get_absolute_time());
+void SeismicMonitor::poll_sampling(uint32_t budget_us) {
+    (void)budget_us;
+    sample_once();
+}
+
+void SeismicMonitor::start_acquisition_core1() {
+    core1_monitor = this;
+    multicore_launch_core1(core1_entry);
+    printf("[SeismicMonitor] Adquisición lanzada en core1\n");
+}
+
+void SeismicMonitor::core1_entry() {
+    SeismicMonitor* self = core1_monitor;
+    const uint64_t period_us = (uint64_t)cfg::SENSOR_READ_INTERVAL * 1000u;
+    
+    // Las escrituras del diario en flash (core0) detienen este núcleo
+    flash_safe_execute_core_init();
     
-    // 1. Leer datos del sensor periódicamente
-    if (current_time - last_sensor_read >= cfg::SENSOR_READ_INTERVAL) {
-        last_sensor_read = current_time;
+    // La ISR de DATA_RDY debe vivir en el núcleo que adquiere
+    bool irq = self->sensor->enable_data_ready_irq(cfg::MPU6050_INT_PIN);
+    absolute_time_t next = get_absolute_time();
+    
+    while (true) {
+        self->sample_once();
+        next = delayed_by_us(next, period_us);
         
-        SensorData data;
-        if (sensor->read_sensor_data(data)) {
-            // Reset contador de errores en lecturas exitosas
-            if (consecutive_errors > 0) {
-                consecutive_errors--;
-            }
-            
-            // Agregar al buffer
-            add_to_buffer(data);
-            
-            // Imprimir datos del sensor en terminal
-            printf("[MPU6050] Accel: X=%.3f, Y=%.3f, Z=%.3f m/s² | Gyro: X=%.2f, Y=%.2f, Z=%.2f °/s | Mag: %.3f m/s²\n",
-                   data.accel_x, data.accel_y, data.accel_z,
-                   data.gyro_x, data.gyro_y, data.gyro_z,
-                   data.magnitude);
-            
-            // Verificar si es un evento significativo
-            if (sensor->is_significant_movement(data, cfg::VIBRATION_THRESHOLD)) {
-                SeismicEvent event;
-                event.data = data;
-                event.is_significant = data.magnitude >= cfg::EARTHQUAKE_THRESHOLD;
-                event.event_type = sensor->get_event_type(data.magnitude);
-                event.detected_at = current_time;
-                
-                printf("[SeismicMonitor] Evento detectado: %s (magnitud: %.2f m/s²)\n",
-                       event.event_type, data.magnitude);
-                
-                // Enviar inmediatamente si hay conectividad
-                if (is_wifi_connected()) {
-                    send_sensor_data_to_api(event);
-                    last_api_send = current_time;
-                }
-            }
-        } else {
-            consecutive_errors++;
-            printf("[SeismicMonitor] Error leyendo sensor (%d errores consecutivos)\n", consecutive_errors);
-            
-            // Si hay muchos errores, intentar reinicializar
-            if (consecutive_errors >= MAX_CONSECUTIVE_ERRORS) {
-                printf("[SeismicMonitor] Demasiados errores, reintentando inicialización...\n");
-                sensor_initialized = sensor->init();
-                consecutive_errors = MAX_CONSECUTIVE_ERRORS / 2; // Reset parcial
+        // Con DATA_RDY la ISR despierta al núcleo y el vaciado se adelanta en
+        // cuanto hay un lote listo; el plazo queda como respaldo.
+        bool early = false;
+        while (!time_reached(next)) {
+            if (irq && self->sensor->samples_pending() >= (uint32_t)cfg::FIFO_DRAIN_SAMPLES) {
+                early = true;
+                break;
             }
+            best_effort_wfe_or_timeout(next);
+        }
+        
+        absolute_time_t now = get_absolute_time();
+        if (early) {
+            next = now;
+            continue;
+        }
+        
+        uint64_t lag = (uint64_t)absolute_time_diff_us(next, now);
+        if (lag > self->core1_max_jitter_us) self->core1_max_jitter_us = (uint32_t)lag;
+        if (lag > period_us) {
+            // Nos saltamos un ciclo completo: re-sincronizar sin ráfagas
+            self->core1_late = self->core1_late + 1;
+            next = now;
         }
     }
+}
+
+void SeismicMonitor::drain_samples() {
+    SseHub* live = server ? &server->live_stream() : nullptr;
+    SensorData data;
+    while (sample_queue.pop(data)) {
+        add_to_buffer(data);
+        mag_stats.add(data.magnitude);
+        append_continuous(data);
+        if (live) live->add_sample(data);
+    }
     
-    // 2. Enviar lecturas continuas del sensor al API (cada 5 segundos)
-    if (current_time - last_api_send >= cfg::API_SEND_INTERVAL) {
-        if (is_wifi_connected()) {
-            SensorData current_data = get_current_sensor_data();
-            send_continuous_sensor_data_to_api(current_data);
-            last_api_send = current_time;
+    // Un aviso a la vez: el resto espera en la cola (dos por evento)
+    if (has_pending_event || !event_queue.pop(pending_event)) return;
+    has_pending_event = true;
+    
+    if (live && live->active()) {
+        const SeismicEvent& e = pending_event;
+        char json[192];
+        if (e.phase == SeismicEvent::ONSET) {
+            std::snprintf(json, sizeof(json),
+                "{\"id\":%lu,\"t\":%llu,\"type\":\"%s\",\"magnitude\":%.3f,\"sta_lta\":%.2f}",
+                (unsigned long)e.event_id, (unsigned long long)e.detected_at, e.event_type,
+                fx::accel_to_mps2(e.data.magnitude), e.sta_lta_ratio_q8 / 256.0f);
+            live->publish("trigger", json);
+        } else {
+            std::snprintf(json, sizeof(json),
+                "{\"id\":%lu,\"t\":%llu,\"type\":\"%s\",\"duration_ms\":%lu,"
+                "\"pga\":[%.3f,%.3f,%.3f],\"peak_t\":%llu}",
+                (unsigned long)e.event_id, (unsigned long long)e.detected_at, e.event_type,
+                (unsigned long)e.duration_ms, fx::accel_to_mps2(e.pga[0]),
+                fx::accel_to_mps2(e.pga[1]), fx::accel_to_mps2(e.pga[2]),
+                (unsigned long long)e.data.timestamp);
+            live->publish("summary", json);
+        }
+    }
+}
+
+void SeismicMonitor::sample_once() {
+    // Vaciar la FIFO del sensor en una sola ráfaga
+    // Peticiones de core0: se aplican aquí para que el contador tenga un
+    // solo escritor
+    if (reset_errors_requested.exchange(false)) consecutive_errors.store(0);
+    if (calibration_requested.exchange(false)) {
+        if (sensor->calibrate(cfg::CALIBRATION_SAMPLES)) {
+            consecutive_errors.store(0);
         }
+        restart_pipeline();
     }
     
-    // 3. Enviar estado periódico al API
-    if (current_time - last_status_send >= cfg::STATUS_SEND_INTERVAL) {
-        if (is_wifi_connected()) {
-            send_status_to_api();
-            last_status_send = current_time;
+    int n = sensor->read_fifo_batch(batch, cfg::FIFO_BATCH_MAX);
+    int errors = consecutive_errors.load(std::memory_order_relaxed);
+    if (n >= 0) {
+        // Reset contador de errores en lecturas exitosas
+        if (errors > 0) {
+            consecutive_errors.store(errors - 1, std::memory_order_relaxed);
+        }
+        
+        for (int i = 0; i < n; i++) {
+            Metrics::Scope scope(Metrics::PROCESS);
+            process_sample(batch[i]);
+        }
+        
+        // Al log solo la muestra más reciente del lote (nivel DEBUG; sin él
+        // ni se convierten las unidades)
+        if (n > 0 && Log::enabled(Log::MPU, Log::DEBUG)) {
+            const SensorData& data = batch[n - 1];
+            Log::debug(Log::MPU, "Accel: X=%.3f, Y=%.3f, Z=%.3f m/s² | Gyro: X=%.2f, Y=%.2f, Z=%.2f °/s | Mag: %.3f m/s² (%d muestras)\n",
+                       fx::accel_to_mps2(data.accel_x), fx::accel_to_mps2(data.accel_y), fx::accel_to_mps2(data.accel_z),
+                       fx::gyro_to_dps(data.gyro_x), fx::gyro_to_dps(data.gyro_y), fx::gyro_to_dps(data.gyro_z),
+                       fx::accel_to_mps2(data.magnitude), n);
         }
+    } else {
+        errors++;
+        Log::warn(Log::MONITOR, "Error leyendo sensor (%d errores consecutivos)\n", errors);
+        
+        // Si hay muchos errores, intentar reinicializar
+        if (errors >= MAX_CONSECUTIVE_ERRORS) {
+            Log::error(Log::MONITOR, "Demasiados errores, reintentando inicialización...\n");
+            sensor_initialized = sensor->init() && sensor->init_fifo(cfg::SAMPLE_RATE_HZ);
+            errors = MAX_CONSECUTIVE_ERRORS / 2; // Reset parcial
+            restart_pipeline();
+        }
+        consecutive_errors.store(errors, std::memory_order_relaxed);
     }
 }
 
-void SeismicMonitor::add_to_buffer(const SensorData& data) {
-    sensor_buffer[buffer_index] = data;
-    buffer_index = (buffer_index + 1) % BUFFER_SIZE;
+void SeismicMonitor::restart_pipeline() {
+    // El evento en curso (y su captura) termina solo al no haber más
+    // muestras activas
+    filters.reset();
+    detector.reset();
+    Log::info(Log::MONITOR, "Filtros y detector reiniciados\n");
+}
+
+void SeismicMonitor::process_sample(const SensorData& raw) {
+    // Filtrado por eje: fuera gravedad/deriva, dentro solo la banda sísmica.
+    // La magnitud se recalcula sobre la aceleración dinámica.
+    // La forma de onda guarda la aceleración sin filtrar
+    capture.push(raw);
+    Metrics::count(Metrics::SAMPLES);
     
-    if (buffer_index == 0) {
-        buffer_full = true;
+    uint32_t t0 = time_us_32();
+    SensorData data = raw;
+    filters.process(data.accel_x, data.accel_y, data.accel_z);
+    data.magnitude_sq = fx::magnitude_sq(data.accel_x, data.accel_y, data.accel_z);
+    data.magnitude = (uint16_t)fx::isqrt32(data.magnitude_sq);
+    uint32_t t1 = time_us_32();
+    Metrics::record(Metrics::FILTER, t1 - t0);
+    
+    // Publicar para core0 (drain_samples lo pasa al buffer)
+    sample_queue.push(data);
+    
+    // Detector STA/LTA sobre |a| (cuentas), O(1) por muestra
+    StaLtaDetector::Edge edge = detector.update(data.magnitude);
+    
+    if (edge == StaLtaDetector::DETRIGGERED) {
+        Log::debug(Log::MONITOR, "Fin de disparo STA/LTA\n");
+    }
+    
+    // Mientras la LTA se calienta, solo un golpe fuerte cuenta como disparo.
+    // Los disparos seguidos se funden en un solo evento con inicio y resumen;
+    // la captura sigue al evento y comparte su id.
+    bool fallback = !detector.is_warmed_up() && data.magnitude_sq >= fx::EARTHQUAKE_THRESHOLD_SQ;
+    bool active = detector.is_triggered() || fallback;
+    uint32_t ratio = active ? detector.ratio_q8() : 0;
+    
+    EventTracker::Edge event_edge = tracker.update(data, active, ratio);
+    Metrics::record(Metrics::DETECT, time_us_32() - t1);
+    
+    switch (event_edge) {
+    case EventTracker::ONSET:
+        capture.trigger(tracker.current().event_id, ratio);
+        emit_event(SeismicEvent::ONSET, tracker.current());
+        break;
+    case EventTracker::ENDED:
+        capture.detrigger();
+        emit_event(SeismicEvent::SUMMARY, tracker.current());
+        break;
+    default:
+        break;
+    }
+}
+
+void SeismicMonitor::emit_event(SeismicEvent::Phase phase, const EventTracker::Summary& s) {
+    SeismicEvent event = {};
+    event.phase = phase;
+    event.event_id = s.event_id;
+    event.data = phase == SeismicEvent::ONSET ? s.onset : s.peak;
+    event.is_significant = event.data.magnitude_sq >= fx::EARTHQUAKE_THRESHOLD_SQ;
+    event.event_type = sensor->get_event_type(event.data.magnitude_sq);
+    if (event.data.magnitude_sq < fx::VIBRATION_THRESHOLD_SQ) {
+        event.event_type = "trigger"; // disparo STA/LTA por debajo del umbral de vibración
     }
+    event.sta_lta_ratio_q8 = phase == SeismicEvent::ONSET ? s.onset_ratio_q8 : s.peak_ratio_q8;
+    event.detected_at = s.onset.timestamp;
+    
+    if (phase == SeismicEvent::ONSET) {
+        Log::info(Log::MONITOR, "Inicio del evento %lu: %s (magnitud: %.2f m/s², STA/LTA: %.2f)\n",
+                  (unsigned long)event.event_id, event.event_type,
+                  fx::accel_to_mps2(event.data.magnitude), event.sta_lta_ratio_q8 / 256.0f);
+    } else {
+        event.duration_ms = s.duration_ms();
+        for (int k = 0; k < 3; k++) event.pga[k] = s.pga[k];
+        event.triggers = s.triggers;
+        event.truncated = s.truncated;
+        Log::info(Log::MONITOR, "Fin del evento %lu: %s, %.1f s, %u disparos, PGA %.2f/%.2f/%.2f m/s²\n",
+                  (unsigned long)event.event_id, event.event_type, event.duration_ms / 1000.0f,
+                  (unsigned)event.triggers, fx::accel_to_mps2(event.pga[0]),
+                  fx::accel_to_mps2(event.pga[1]), fx::accel_to_mps2(event.pga[2]));
+    }
+    
+    // El envío lo hace poll_uplink(); el muestreo nunca espera a la red
+    event_queue.push(event);
 }
 
-float SeismicMonitor::calculate_average_magnitude(int samples) const {
-    if (!buffer_full && buffer_index == 0) return 0.0f;
+void SeismicMonitor::poll_uplink(uint32_t budget_us) {
+    (void)budget_us;
+    uint64_t current_time = to_ms_since_boot(get_absolute_time());
+    
+    drain_samples();
+    
+    // 0. Recoger el resultado del envío en vuelo
+    if (upload_msg) {
+        AsyncHttpClient::Result r = server->http_client().result(upload_handle);
+        if (r.state != AsyncHttpClient::QUEUED && r.state != AsyncHttpClient::IN_FLIGHT) {
+            server->http_client().release(upload_handle);
+            finish_upload(r.state == AsyncHttpClient::DONE, r.http_status);
+        }
+    }
     
-    int actual_samples = buffer_full ? BUFFER_SIZE : buffer_index;
-    if (samples > actual_samples) samples = actual_samples;
+    // 1. Evento pendiente o siguiente trozo de forma de onda al diario (a la
+    //    cola si no hay diario), haya red o no. Una operación de flash por
+    //    paso; el borrado del siguiente sector, solo con el ESP en silencio.
+    if (journal.ready() && !journal.prepared() && server && server->link_idle()) {
+        journal.prepare();
+    } else if (has_pending_event) {
+        store_pending_event();
+    } else {
+        store_waveform_chunk();
+    }
     
-    float sum = 0.0f;
-    int start_idx = buffer_full ? buffer_index : 0;
+    // 2. Del diario a la cola, lo más antiguo primero
+    if (journal.ready()) {
+        feed_from_journal(UplinkQueue::ALERT, FlashJournal::REC_EVENT);
+        feed_from_journal(UplinkQueue::WAVEFORM, FlashJournal::REC_WAVEFORM);
+    }
+    
+    // 3. Flujo continuo: un lote a medias sale cada API_SEND_INTERVAL
+    if (current_time - last_api_send >= cfg::API_SEND_INTERVAL) {
+        close_continuous_batch();
+        last_api_send = current_time;
+    }
     
-    for (int i = 0; i < samples; i++) {
-        int idx = (start_idx - 1 - i + BUFFER_SIZE) % BUFFER_SIZE;
-        sum += sensor_buffer[idx].magnitude;
+    // 4. Estado periódico
+    if (current_time - last_status_send >= cfg::STATUS_SEND_INTERVAL) {
+        queue_status();
+        last_status_send = current_time;
     }
     
-    return sum / samples;
+    // 5. Con red y el cliente libre sale el mensaje de mayor prioridad
+    if (!upload_msg && is_wifi_connected()) {
+        UplinkQueue::Message* m = uplink.next((uint32_t)current_time);
+        if (m && !submit_upload(m)) uplink.requeue(m);
+    }
 }
 
-bool SeismicMonitor::is_wifi_connected() {
-    // Verificación simple basada en si el servidor HTTP está funcionando
-    // En una implementación más robusta, se podría hacer ping al API
-    return server != nullptr; // Placeholder - mejorar implementación
+bool SeismicMonitor::submit_upload(UplinkQueue::Message* m) {
+    if (!server) return false;
+    AsyncHttpClient::Request req = {cfg::API_HOST, cfg::API_PORT, m->path, m->content_type, m->body, m->len};
+    upload_handle = server->http_client().submit(req);
+    if (upload_handle == AsyncHttpClient::INVALID_HANDLE) return false;
+    upload_msg = m;
+    return true;
 }
 
-bool SeismicMonitor::send_sensor_data_to_api(const SeismicEvent& event) {
-    if (!server) return false;
+void SeismicMonitor::finish_upload(bool success, int http_status) {
+    UplinkQueue::Message* m = upload_msg;
+    upload_msg = nullptr;
+    upload_handle = AsyncHttpClient::INVALID_HANDLE;
+    
+    // complete() libera el hueco: lo que haga falta se copia antes
+    UplinkQueue::Class cls = m->cls;
+    FlashJournal::Entry record = {};
+    record.offset = m->journal_offset;
+    record.seq = m->journal_seq;
     
-    char json_buffer[512];
-    format_sensor_data_json(event, json_buffer, sizeof(json_buffer));
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    UplinkQueue::Outcome outcome = uplink.complete(m, success, http_status, now);
+    
+    switch (outcome) {
+    case UplinkQueue::SENT:
+        if (cls == UplinkQueue::ALERT) Log::info(Log::MONITOR, "Evento sísmico enviado exitosamente\n");
+        break;
+    case UplinkQueue::RETRY:
+        Log::warn(Log::MONITOR, "Error enviando %s al API (HTTP %d), intento %d\n",
+                  UplinkQueue::class_name(cls), http_status, m->attempts);
+        break;
+    case UplinkQueue::DROPPED:
+        Log::warn(Log::MONITOR, "Mensaje de %s descartado (HTTP %d)\n",
+                  UplinkQueue::class_name(cls), http_status);
+        break;
+    }
     
-    printf("[SeismicMonitor] Enviando evento sísmico al API: %s\n", json_buffer);
+    // Entregado o rechazado: el diario ya no tiene que guardarlo
+    if (record.seq != 0 && outcome != UplinkQueue::RETRY) journal.ack(record);
+}
+
+static batch::Header make_batch_header(batch::Kind kind, uint8_t flags) {
+    batch::Header h = {};
+    h.version = batch::VERSION;
+    h.kind = kind;
+    h.flags = flags;
+    h.channels = batch::CHANNELS;
+    strncpy(h.device_id, cfg::DEVICE_ID, batch::DEVICE_ID_LEN);
+    h.sample_rate_hz = cfg::SAMPLE_RATE_HZ;
+    h.counts_per_g = (uint16_t)fx::ACCEL_COUNTS_PER_G;
+    return h;
+}
+
+// Codifica el siguiente trozo de upload_record a partir de upload_offset;
+// deja en upload_chunk_samples cuántas muestras lleva
+size_t SeismicMonitor::encode_waveform_chunk(uint8_t* buffer, size_t capacity) {
+    const CaptureRecord& r = *upload_record;
     
-    // Usar el método del servidor para enviar datos
-    bool success = server->http_post_json(cfg::API_HOST, cfg::API_PORT, cfg::API_ENDPOINT, json_buffer);
+    // Tantas muestras como quepan en un lote (depende de cuánto se muevan)
+    batch::Header h = make_batch_header(batch::KIND_WAVEFORM, r.truncated ? batch::FLAG_TRUNCATED : 0);
+    h.start_us = r.start_us();
+    h.event_id = r.event_id;
+    h.first_index = upload_offset;
+    h.total_count = r.count;
+    h.trigger_index = r.pre_count > 0 ? r.pre_count - 1 : 0;
+    h.sta_lta_ratio_q8 = r.sta_lta_ratio_q8;
     
-    if (success) {
-        printf("[SeismicMonitor] Evento sísmico enviado exitosamente\n");
+    batch::Encoder enc;
+    enc.begin(buffer, capacity, h);
+    for (uint32_t i = upload_offset; i < r.count; i++) {
+        const CaptureSample& s = r.at(i);
+        if (!enc.add(s.ax, s.ay, s.az)) break;
+    }
+    upload_chunk_samples = enc.count();
+    return enc.finish();
+}
+
+// Evento pendiente al diario o, sin diario, a la cola de alertas. Si no
+// cabe se conserva (drain_samples() se queda con el más fuerte).
+bool SeismicMonitor::store_pending_event() {
+    if (journal.ready()) {
+        format_sensor_data_json(pending_event, event_json, sizeof(event_json));
+        size_t len = strlen(event_json);
+        if (journal.needs_erase(len)) return false;    // espera a prepare()
+        if (!journal.append(FlashJournal::REC_EVENT, event_json, len)) {
+            Log::warn(Log::MONITOR, "Error guardando el evento en el diario, se reintenta\n");
+            return false;
+        }
     } else {
-        printf("[SeismicMonitor] Error enviando evento sísmico al API\n");
+        UplinkQueue::Message* m = uplink.reserve(UplinkQueue::ALERT);
+        if (!m) return false;
+        format_sensor_data_json(pending_event, (char*)m->body, m->capacity);
+        uplink.commit(m, strlen((const char*)m->body), cfg::API_ENDPOINT, "application/json");
     }
-    
-    return success;
+    has_pending_event = false;
+    Log::info(Log::MONITOR, "Evento sísmico guardado para envío\n");
+    return true;
 }
 
-bool SeismicMonitor::send_continuous_sensor_data_to_api(const SensorData& data) {
-    if (!server) return false;
+// Siguiente trozo de la forma de onda de un evento cerrado, al diario o a
+// la cola. El registro de captura se libera al pasar el último trozo.
+bool SeismicMonitor::store_waveform_chunk() {
+    if (!upload_record) {
+        upload_record = capture.acquire();
+        upload_offset = 0;
+        upload_failures = 0;
+    }
+    if (!upload_record) return false;
+    const CaptureRecord& r = *upload_record;
+    
+    if (journal.ready()) {
+        size_t len = encode_waveform_chunk(upload_buffer, sizeof(upload_buffer));
+        if (journal.needs_erase(len)) return false;    // espera a prepare()
+        if (journal.append(FlashJournal::REC_WAVEFORM, upload_buffer, len)) {
+            upload_offset += upload_chunk_samples;
+            upload_failures = 0;
+        } else if (++upload_failures >= MAX_UPLOAD_FAILURES) {
+            Log::warn(Log::MONITOR, "Forma de onda del evento %lu descartada: el diario no la admite\n",
+                      (unsigned long)r.event_id);
+            upload_offset = r.count;
+        }
+    } else {
+        UplinkQueue::Message* m = uplink.reserve(UplinkQueue::WAVEFORM);
+        if (!m) return false;   // la cola de formas de onda está llena
+        size_t len = encode_waveform_chunk(m->body, m->capacity);
+        uplink.commit(m, len, cfg::API_WAVEFORM_ENDPOINT, batch::CONTENT_TYPE);
+        upload_offset += upload_chunk_samples;
+    }
     
-    char json_buffer[512];
-    format_continuous_sensor_data_json(data, json_buffer, sizeof(json_buffer));
+    if (upload_offset >= r.count) {
+        capture.release(upload_record);
+        upload_record = nullptr;
+    }
+    return true;
+}
+
+// Copia a la cola el siguiente registro del diario de ese tipo. Se copia
+// porque un append() puede reciclar su sector mientras espera o está en
+// vuelo; el acuse lo hace finish_upload() con offset y secuencia.
+void SeismicMonitor::feed_from_journal(UplinkQueue::Class cls, FlashJournal::RecordType type) {
+    if (!uplink.has_room(cls) || journal_drained_at[cls] == journal.appended()) return;
     
-    printf("[SeismicMonitor] Enviando datos continuos al API\n");
+    FlashJournal::Entry e;
+    if (!journal.peek(e, type, journal_fed[cls])) {
+        journal_drained_at[cls] = journal.appended();
+        return;
+    }
+    journal_fed[cls] = e.seq;
     
-    // Usar el método del servidor para enviar datos
-    bool success = server->http_post_json(cfg::API_HOST, cfg::API_PORT, cfg::API_ENDPOINT, json_buffer);
+    if (e.len > UplinkQueue::policy(cls).slot_size) {
+        Log::warn(Log::MONITOR, "Registro %lu del diario demasiado grande, se descarta\n",
+                  (unsigned long)e.seq);
+        journal.ack(e);
+        return;
+    }
     
-    if (success) {
-        printf("[SeismicMonitor] Datos continuos enviados exitosamente\n");
+    UplinkQueue::Message* m = uplink.reserve(cls);
+    memcpy(m->body, e.data, e.len);
+    m->journal_offset = e.offset;
+    m->journal_seq = e.seq;
+    if (type == FlashJournal::REC_EVENT) {
+        uplink.commit(m, e.len, cfg::API_ENDPOINT, "application/json");
     } else {
-        printf("[SeismicMonitor] Error enviando datos continuos al API\n");
+        uplink.commit(m, e.len, cfg::API_WAVEFORM_ENDPOINT, batch::CONTENT_TYPE);
+    }
+}
+
+void SeismicMonitor::append_continuous(const SensorData& data) {
+    const uint64_t period_us = 1000000 / cfg::SAMPLE_RATE_HZ;
+    
+    // Un lote implica muestras equiespaciadas: un hueco (FIFO desbordada,
+    // cola llena) o un lote lleno obligan a cerrarlo
+    if (continuous_encoder.count() > 0) {
+        bool gap = data.timestamp_us > continuous_next_us + period_us / 2 ||
+                   data.timestamp_us + period_us / 2 < continuous_next_us;
+        if (gap || !continuous_encoder.has_room()) close_continuous_batch();
     }
     
-    return success;
+    if (!continuous_encoder.is_open()) {
+        // Sin hueco libre la cola pisa el lote en espera más antiguo
+        continuous_slot = uplink.reserve(UplinkQueue::TELEMETRY);
+        if (!continuous_slot) {
+            continuous_dropped++;   // todos los huecos en vuelo
+            return;
+        }
+        batch::Header h = make_batch_header(batch::KIND_CONTINUOUS, batch::FLAG_FILTERED);
+        h.start_us = data.timestamp_us;
+        continuous_encoder.begin(continuous_slot->body, continuous_slot->capacity, h);
+    }
+    
+    continuous_encoder.add(data.accel_x, data.accel_y, data.accel_z);
+    continuous_next_us = data.timestamp_us + period_us;
 }
 
-bool SeismicMonitor::send_status_to_api() {
-    printf("[SeismicMonitor] Enviando estado al API...\n");
+void SeismicMonitor::close_continuous_batch() {
+    if (!continuous_slot || continuous_encoder.count() == 0) return;
     
-    char json_buffer[256];
-    float avg_magnitude = calculate_average_magnitude(10);
+    size_t len = continuous_encoder.finish();
+    uplink.commit(continuous_slot, len, cfg::API_BATCH_ENDPOINT, batch::CONTENT_TYPE);
+    continuous_slot = nullptr;
+}
+
+void SeismicMonitor::add_to_buffer(const SensorData& data) {
+    sensor_buffer[buffer_index] = data;
+    buffer_index = (buffer_index + 1) % BUFFER_SIZE;
     
-    snprintf(json_buffer, sizeof(json_buffer),
+    if (buffer_index == 0) {
+        buffer_full = true;
+    }
+}
+
+int SeismicMonitor::format_window_stats_json(const WindowStats& w, char* json_buffer, size_t buffer_size) {
+    return snprintf(json_buffer, buffer_size,
+        "{\"n\":%lu,\"mean\":%.4f,\"var\":%.6f,\"rms\":%.4f,\"peak\":%.4f,\"min\":%.4f}",
+        (unsigned long)w.count(),
+        fx::accel_to_mps2(w.mean()),
+        fx::accel_sq_to_mps2sq(w.variance()),
+        fx::accel_to_mps2((int32_t)w.rms()),
+        fx::accel_to_mps2(w.peak()),
+        fx::accel_to_mps2(w.min()));
+}
+
+bool SeismicMonitor::is_wifi_connected() {
+    // El servidor sigue los eventos WIFI DISCONNECT / WIFI GOT IP del ESP
+    return server != nullptr && server->wifi_connected();
+}
+
+// Estado al hueco de la cola; uno que no llegó a salir se pisa
+bool SeismicMonitor::queue_status() {
+    UplinkQueue::Message* m = uplink.reserve(UplinkQueue::STATUS);
+    if (!m) return false;
+    char* status_json = (char*)m->body;
+    
+    uint32_t json_start = time_us_32();
+    char w1s[128], w10s[128], w60s[128];
+    format_window_stats_json(mag_stats.w1s, w1s, sizeof(w1s));
+    format_window_stats_json(mag_stats.w10s, w10s, sizeof(w10s));
+    format_window_stats_json(mag_stats.w60s, w60s, sizeof(w60s));
+    float avg_magnitude = fx::accel_to_mps2(mag_stats.w1s.mean());
+    
+    snprintf(status_json, m->capacity,
         "{"
         "\"device_id\":\"%s\","
         "\"timestamp\":%lu,"
@@ -188,30 +606,36 @@ bool SeismicMonitor::send_status_to_api() {
         "\"sensor_ok\":%s,"
         "\"avg_magnitude\":%.3f,"
         "\"buffer_count\":%d,"
-        "\"errors\":%d"
+        "\"errors\":%d,"
+        "\"stats\":{\"1s\":%s,\"10s\":%s,\"60s\":%s}"
         "}",
         cfg::DEVICE_ID,
         (unsigned long)to_ms_since_boot(get_absolute_time()),
         is_sensor_ok() ? "true" : "false",
         avg_magnitude,
         get_buffer_count(),
-        consecutive_errors
+        consecutive_errors.load(),
+        w1s, w10s, w60s
     );
+    Metrics::record(Metrics::JSON, time_us_32() - json_start);
     
-    printf("[SeismicMonitor] Estado: %s\n", json_buffer);
-    
-    // Enviar al endpoint de estado (puedes crear uno diferente si lo necesitas)
-    if (server) {
-        return server->http_post_json(cfg::API_HOST, cfg::API_PORT, "/api/pico/status", json_buffer);
-    }
+    // El log diferido no puede guardar el JSON (vive en el mensaje de la cola)
+    Log::debug(Log::MONITOR, "Estado encolado: %u bytes, |a| media %.3f m/s², %d errores\n",
+               (unsigned)strlen(status_json), avg_magnitude, consecutive_errors.load());
     
-    return false;
+    uplink.commit(m, strlen(status_json), "/api/pico/status", "application/json");
+    return true;
 }
 
+// Campos de siempre (muestra del inicio o del pico) más el ciclo de vida;
+// el resumen añade duración, PGA por eje e instante del pico
 void SeismicMonitor::format_sensor_data_json(const SeismicEvent& event, char* json_buffer, size_t buffer_size) {
-    snprintf(json_buffer, buffer_size,
+    Metrics::Scope timer(Metrics::JSON);
+    int n = snprintf(json_buffer, buffer_size,
         "{"
         "\"device_id\":\"%s\","
+        "\"event_id\":%lu,"
+        "\"phase\":\"%s\","
         "\"timestamp\":%lu,"
         "\"acceleration_x\":%.6f,"
         "\"acceleration_y\":%.6f,"
@@ -221,47 +645,42 @@ void SeismicMonitor::format_sensor_data_json(const SeismicEvent& event, char* js
         "\"gyro_z\":%.3f,"
         "\"magnitude\":%.6f,"
         "\"event_type\":\"%s\","
-        "\"is_significant\":%s"
-        "}",
+        "\"sta_lta_ratio\":%.2f,"
+        "\"is_significant\":%s",
         cfg::DEVICE_ID,
-        (unsigned long)event.data.timestamp,
-        event.data.accel_x,
-        event.data.accel_y,
-        event.data.accel_z,
-        event.data.gyro_x,
-        event.data.gyro_y,
-        event.data.gyro_z,
-        event.data.magnitude,
+        (unsigned long)event.event_id,
+        event.phase == SeismicEvent::ONSET ? "onset" : "summary",
+        (unsigned long)event.detected_at,
+        fx::accel_to_mps2(event.data.accel_x),
+        fx::accel_to_mps2(event.data.accel_y),
+        fx::accel_to_mps2(event.data.accel_z),
+        fx::gyro_to_dps(event.data.gyro_x),
+        fx::gyro_to_dps(event.data.gyro_y),
+        fx::gyro_to_dps(event.data.gyro_z),
+        fx::accel_to_mps2(event.data.magnitude),
         event.event_type,
+        event.sta_lta_ratio_q8 / 256.0f,
         event.is_significant ? "true" : "false"
     );
-}
-
-void SeismicMonitor::format_continuous_sensor_data_json(const SensorData& data, char* json_buffer, size_t buffer_size) {
-    snprintf(json_buffer, buffer_size,
-        "{"
-        "\"device_id\":\"%s\","
-        "\"timestamp\":%lu,"
-        "\"acceleration_x\":%.6f,"
-        "\"acceleration_y\":%.6f,"
-        "\"acceleration_z\":%.6f,"
-        "\"gyro_x\":%.3f,"
-        "\"gyro_y\":%.3f,"
-        "\"gyro_z\":%.3f,"
-        "\"magnitude\":%.6f,"
-        "\"event_type\":\"normal\","
-        "\"is_significant\":false"
-        "}",
-        cfg::DEVICE_ID,
-        (unsigned long)data.timestamp,
-        data.accel_x,
-        data.accel_y,
-        data.accel_z,
-        data.gyro_x,
-        data.gyro_y,
-        data.gyro_z,
-        data.magnitude
-    );
+    if (n < 0 || (size_t)n >= buffer_size) return;
+    
+    if (event.phase == SeismicEvent::SUMMARY) {
+        n += snprintf(json_buffer + n, buffer_size - n,
+            ",\"duration_ms\":%lu,"
+            "\"peak_timestamp\":%lu,"
+            "\"pga_x\":%.4f,\"pga_y\":%.4f,\"pga_z\":%.4f,"
+            "\"triggers\":%u,"
+            "\"truncated\":%s",
+            (unsigned long)event.duration_ms,
+            (unsigned long)event.data.timestamp,
+            fx::accel_to_mps2(event.pga[0]),
+            fx::accel_to_mps2(event.pga[1]),
+            fx::accel_to_mps2(event.pga[2]),
+            (unsigned)event.triggers,
+            event.truncated ? "true" : "false");
+        if (n < 0 || (size_t)n >= buffer_size) return;
+    }
+    snprintf(json_buffer + n, buffer_size - n, "}");
 }
 
 int SeismicMonitor::get_buffer_count() const {
@@ -272,7 +691,7 @@ float SeismicMonitor::get_current_magnitude() const {
     if (get_buffer_count() == 0) return 0.0f;
     
     int last_idx = (buffer_index - 1 + BUFFER_SIZE) % BUFFER_SIZE;
-    return sensor_buffer[last_idx].magnitude;
+    return fx::accel_to_mps2(sensor_buffer[last_idx].magnitude);
 }
 
 bool SeismicMonitor::is_sensor_ok() const {
@@ -280,22 +699,20 @@ bool SeismicMonitor::is_sensor_ok() const {
 }
 
 bool SeismicMonitor::force_calibration() {
-    printf("[SeismicMonitor] Iniciando calibración forzada...\n");
-    if (sensor->calibrate(cfg::CALIBRATION_SAMPLES)) {
-        consecutive_errors = 0;
-        return true;
-    }
-    return false;
+    if (calibration_requested.exchange(true)) return false;
+    printf("[SeismicMonitor] Calibración forzada solicitada\n");
+    return true;
 }
 
 void SeismicMonitor::reset_error_count() {
-    consecutive_errors = 0;
-    printf("[SeismicMonitor] Contador de errores reiniciado\n");
+    // Lo aplica el productor en su siguiente lectura
+    reset_errors_requested.store(true);
+    printf("[SeismicMonitor] Reinicio del contador de errores solicitado\n");
 }
 
 SensorData SeismicMonitor::get_current_sensor_data() const {
     if (get_buffer_count() == 0) {
-        SensorData empty = {0, 0, 0, 0, 0, 0, 0, 0};
+        SensorData empty = {};
         return empty;
     }
     
@@ -307,9 +724,55 @@ void SeismicMonitor::print_sensor_status() const {
     printf("\n===== Estado del Monitor Sísmico =====\n");
     printf("Sensor inicializado: %s\n", sensor_initialized ? "Sí" : "No");
     printf("Sensor OK: %s\n", is_sensor_ok() ? "Sí" : "No");
-    printf("Errores consecutivos: %d/%d\n", consecutive_errors, MAX_CONSECUTIVE_ERRORS);
+    printf("Errores consecutivos: %d/%d\n", consecutive_errors.load(), MAX_CONSECUTIVE_ERRORS);
     printf("Muestras en buffer: %d/%d\n", get_buffer_count(), BUFFER_SIZE);
     printf("Magnitud actual: %.3f m/s²\n", get_current_magnitude());
-    printf("Magnitud promedio (10 muestras): %.3f m/s²\n", calculate_average_magnitude(10));
+    const WindowStats* windows[] = { &mag_stats.w1s, &mag_stats.w10s, &mag_stats.w60s };
+    const char* window_names[] = { "1s", "10s", "60s" };
+    for (int i = 0; i < 3; i++) {
+        const WindowStats& w = *windows[i];
+        printf("Ventana %-3s (%5lu muestras): media %.3f, rms %.3f, desv %.3f, pico %.3f, min %.3f m/s²\n",
+               window_names[i], (unsigned long)w.count(),
+               fx::accel_to_mps2(w.mean()), fx::accel_to_mps2((int32_t)w.rms()),
+               fx::accel_to_mps2((int32_t)fx::isqrt32(w.variance())),
+               fx::accel_to_mps2(w.peak()), fx::accel_to_mps2(w.min()));
+    }
+    printf("STA/LTA: %s, disparos %lu\n",
+           detector.is_warmed_up() ? (detector.is_triggered() ? "disparado" : "armado") : "calentando",
+           (unsigned long)detector.trigger_count());
+    static const char* const kPhases[] = {"sin evento", "en curso", "terminando"};
+    printf("Eventos: %lu, estado %s, avisos perdidos (cola llena) %lu\n",
+           (unsigned long)tracker.events(), kPhases[tracker.phase()],
+           (unsigned long)event_queue.dropped_count());
+    printf("Captura: %s, eventos grabados %lu, sin registro libre %lu\n",
+           capture.is_recording() ? "grabando" : "armada",
+           (unsigned long)capture.events_captured(), (unsigned long)capture.events_missed());
+    if (journal.ready()) {
+        printf("Diario: %lu pendientes, %lu entregados, %lu perdidos (anillo lleno), %lu rotos, borrados máx %lu (%lu sectores)\n",
+               (unsigned long)journal.pending(), (unsigned long)journal.acked(),
+               (unsigned long)journal.lost(), (unsigned long)journal.corrupt(), (unsigned long)journal.max_erase_count(),
+               (unsigned long)journal.sectors());
+        printf("Diario: desbordes de la FIFO del UART durante operaciones de flash %lu, sector siguiente %s\n",
+               (unsigned long)journal.flash_overruns(), journal.prepared() ? "borrado" : "pendiente de borrar");
+    } else {
+        printf("Diario: no disponible\n");
+    }
+    for (int c = 0; c < UplinkQueue::NUM_CLASSES; c++) {
+        const UplinkQueue::Stats& st = uplink.stats((UplinkQueue::Class)c);
+        printf("Cola %-13s: %d/%d, enviados %lu, reintentos %lu, pisados %lu, abandonados %lu\n",
+               UplinkQueue::class_name((UplinkQueue::Class)c), uplink.depth((UplinkQueue::Class)c),
+               UplinkQueue::policy((UplinkQueue::Class)c).slots, (unsigned long)st.sent,
+               (unsigned long)st.retries, (unsigned long)st.dropped, (unsigned long)st.expired);
+    }
+    printf("Muestras continuas descartadas (cola sin hueco): %lu\n", (unsigned long)continuous_dropped);
+    printf("Muestras descartadas (cola llena): %lu\n", (unsigned long)sample_queue.dropped_count());
+    printf("Desbordes FIFO del sensor: %lu\n", (unsigned long)sensor->get_fifo_overflows());
+    printf("DATA_RDY: %s, interrupciones perdidas %lu\n",
+           sensor->has_data_ready_irq() ? "activa" : "inactiva",
+           (unsigned long)sensor->get_irq_missed());
+    if (cfg::DUAL_CORE) {
+        printf("Core1: jitter máx %lu us, ciclos perdidos %lu\n",
+               (unsigned long)core1_max_jitter_us, (unsigned long)core1_late);
+    }
     printf("=====================================\n\n");
 }
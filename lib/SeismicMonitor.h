@@ -3,14 +3,36 @@
 
 #include "MPU6050.h"
 #include "Esp8266HttpServer.h"
+#include "SpscQueue.h"
+#include "StaLta.h"
+#include "Biquad.h"
+#include "WindowStats.h"
+#include "EventCapture.h"
+#include "EventTracker.h"
+#include "BatchFormat.h"
+#include "FlashJournal.h"
+#include "UplinkQueue.h"
 #include "../Config.h"
 #include <queue>
+#include <atomic>
 
+// Aviso de evento hacia core0: uno al empezar (ONSET) y otro con el resumen
+// al terminar (SUMMARY)
 struct SeismicEvent {
-    SensorData data;
+    enum Phase : uint8_t { ONSET, SUMMARY };
+    Phase phase;
+    uint32_t event_id;
+    SensorData data;            // muestra del inicio (ONSET) o de |a| máxima (SUMMARY)
     bool is_significant;
-    const char* event_type;
-    uint64_t detected_at;
+    const char* event_type;     // clasificación por |a| de esa muestra
+    uint32_t sta_lta_ratio_q8;  // STA/LTA en el inicio / máxima (Q8)
+    uint64_t detected_at;       // ms del inicio
+    
+    // Solo SUMMARY
+    uint32_t duration_ms;
+    uint16_t pga[3];            // |a| máxima por eje (cuentas)
+    uint16_t triggers;          // disparos fundidos
+    bool truncated;
 };
 
 class SeismicMonitor {
@@ -24,27 +46,102 @@ private:
     int buffer_index;
     bool buffer_full;
     
+    // Estadísticas de |a| por ventanas (1 s, 10 s, 60 s), O(1) por muestra
+    MagnitudeStats mag_stats;
+    
     // Timing
-    uint64_t last_sensor_read;
     uint64_t last_api_send;
     uint64_t last_status_send;
     
-    // Estado
-    bool sensor_initialized;
-    int consecutive_errors;
+    // Estado (volatile: en modo doble núcleo los escribe core1)
+    volatile bool sensor_initialized;
+    // Solo lo escribe el productor (sample_once); core0 lo lee y, para
+    // ponerlo a cero, lo pide con reset_errors_requested
+    std::atomic<int> consecutive_errors;
+    std::atomic<bool> reset_errors_requested;
+    std::atomic<bool> calibration_requested;
     static const int MAX_CONSECUTIVE_ERRORS = 10;
     
+    // Muestras y eventos del productor (muestreo) al consumidor (red).
+    // En modo doble núcleo el productor corre en core1.
+    SpscQueue<SensorData, 256> sample_queue;
+    SpscQueue<SeismicEvent, 8> event_queue;
+    
+    // Filtros, detector de disparo y ciclo de vida del evento (los usa solo
+    // el productor)
+    AccelFilterBank filters;
+    StaLtaDetector detector;
+    EventTracker tracker;
+    
+    // Forma de onda pre/post disparo (escribe el productor, sube core0)
+    EventCapture capture;
+    const CaptureRecord* upload_record;
+    uint32_t upload_offset;
+    int upload_failures;
+    static const int MAX_UPLOAD_FAILURES = 3;
+    uint32_t upload_chunk_samples;  // muestras del último trozo codificado
+    uint8_t upload_buffer[cfg::BATCH_BUFFER_SIZE];  // trozo camino del diario
+    
+    // Diario en flash: eventos y formas de onda se guardan ahí primero y se
+    // reenvían desde ahí hasta recibir un 2xx (solo core0)
+    FlashJournal journal;
+    uint32_t journal_fed[UplinkQueue::NUM_CLASSES];  // última secuencia pasada a la cola
+    // journal.appended() cuando peek() no encontró nada: hasta que cambie
+    // no hay nada nuevo que buscar
+    uint32_t journal_drained_at[UplinkQueue::NUM_CLASSES];
+    
+    // Cola de salida por prioridades (solo core0): los cuerpos viven en sus
+    // huecos hasta que el envío termina
+    UplinkQueue uplink;
+    
+    // Flujo continuo en lotes binarios (solo core0). El lote se codifica
+    // directamente en un hueco de telemetría de la cola.
+    UplinkQueue::Message* continuous_slot;
+    batch::Encoder continuous_encoder;
+    uint64_t continuous_next_us;    // instante esperado de la siguiente muestra
+    uint32_t continuous_dropped;    // muestras sin hueco en la cola
+    
+    // Subida en vuelo por el cliente HTTP asíncrono (una a la vez)
+    UplinkQueue::Message* upload_msg;
+    AsyncHttpClient::Handle upload_handle;
+    char event_json[cfg::UPLINK_ALERT_BYTES];
+    
+    // Aviso de evento a la espera de poll_uplink(); los siguientes esperan
+    // en event_queue
+    SeismicEvent pending_event;
+    bool has_pending_event;
+    
+    // Jitter de la adquisición en core1
+    volatile uint32_t core1_max_jitter_us;
+    volatile uint32_t core1_late;
+    static SeismicMonitor* core1_monitor;
+    static void core1_entry();
+    
+    // Lote leído de la FIFO (lo usa solo el productor)
+    SensorData batch[cfg::FIFO_BATCH_MAX];
+    
     // Métodos privados
-    bool send_sensor_data_to_api(const SeismicEvent& event);
-    bool send_continuous_sensor_data_to_api(const SensorData& data);
-    bool send_status_to_api();
+    void sample_once();
+    // Tras reinicializar o recalibrar el sensor: vuelve a cebar los filtros
+    // y reinicia el STA/LTA, que si no vería el escalón de los offsets
+    void restart_pipeline();
+    void process_sample(const SensorData& raw);
+    void emit_event(SeismicEvent::Phase phase, const EventTracker::Summary& s);
+    bool submit_upload(UplinkQueue::Message* m);
+    void finish_upload(bool success, int http_status);
+    bool store_pending_event();
+    bool store_waveform_chunk();
+    void feed_from_journal(UplinkQueue::Class cls, FlashJournal::RecordType type);
+    void append_continuous(const SensorData& data);
+    void close_continuous_batch();
+    bool queue_status();
+    size_t encode_waveform_chunk(uint8_t* buffer, size_t capacity);
     void add_to_buffer(const SensorData& data);
-    float calculate_average_magnitude(int samples = 10) const;
     bool is_wifi_connected();
     
     // Formatear datos para JSON
     void format_sensor_data_json(const SeismicEvent& event, char* json_buffer, size_t buffer_size);
-    void format_continuous_sensor_data_json(const SensorData& data, char* json_buffer, size_t buffer_size);
+    static int format_window_stats_json(const WindowStats& w, char* json_buffer, size_t buffer_size);
 
 public:
     SeismicMonitor(MPU6050* mpu_sensor, Esp8266HttpServer* http_server);
@@ -52,15 +149,33 @@ public:
     // Inicializar monitor sísmico
     bool init();
     
-    // Loop principal - debe llamarse continuamente
-    void loop();
+    // Paso de muestreo: una lectura del sensor y detección de eventos.
+    // La cadencia la marca el planificador (cfg::SENSOR_READ_INTERVAL).
+    void poll_sampling(uint32_t budget_us);
+
+    // Paso de subida: guarda eventos y formas de onda en el diario, llena la
+    // cola de salida, lanza el mensaje de mayor prioridad y recoge el
+    // resultado del anterior. No espera a la red: las peticiones avanzan en
+    // Esp8266HttpServer::poll().
+    void poll_uplink(uint32_t budget_us);
+    
+    // Vuelca las colas del productor al buffer local y al evento pendiente.
+    // Debe llamarse desde core0.
+    void drain_samples();
+    
+    // Lanza la adquisición (lectura + detección) en core1 con su propia
+    // cadencia. Tras llamarla no se debe usar poll_sampling().
+    void start_acquisition_core1();
     
     // Obtener estadísticas
     int get_buffer_count() const;
     float get_current_magnitude() const;
     bool is_sensor_ok() const;
+    const MagnitudeStats& get_magnitude_stats() const { return mag_stats; }
     
-    // Métodos de control manual
+    // Métodos de control manual. La calibración la hace el productor entre
+    // dos lecturas (no comparte el I2C con core1); devuelve false si ya
+    // había una pendiente.
     bool force_calibration();
     void reset_error_count();
     
@@ -0,0 +1,60 @@
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+
+// Cola lock-free de un productor y un consumidor (p. ej. core1 -> core0).
+// N debe ser potencia de dos. Los índices crecen libremente y se enmascaran
+// al acceder, así que caben N elementos útiles.
+template <typename T, uint32_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N debe ser potencia de dos");
+
+public:
+    SpscQueue() : head(0), tail(0), dropped(0) {}
+
+    // Productor. Devuelve false (y cuenta la pérdida) si la cola está llena.
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor. Devuelve false si la cola está vacía.
+    bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor. Copia el primer elemento sin retirarlo.
+    bool peek(T& item) const {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = items[t & (N - 1)];
+        return true;
+    }
+
+    uint32_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    uint32_t dropped_count() const { return dropped.load(std::memory_order_relaxed); }
+    static constexpr uint32_t capacity() { return N; }
+
+private:
+    T items[N];
+    std::atomic<uint32_t> head;     // escrito solo por el productor
+    std::atomic<uint32_t> tail;     // escrito solo por el consumidor
+    std::atomic<uint32_t> dropped;  // escrito solo por el productor
+};
+
+#endif // SPSC_QUEUE_H_
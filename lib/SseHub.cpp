@@ -0,0 +1,82 @@
+#include "SseHub.h"
+#include "../Config.h"
+#include <cstdio>
+#include <cstring>
+
+static_assert(cfg::SSE_DECIMATION >= 1, "decimación inválida");
+
+SseHub::SseHub()
+    : next_seq(0), listeners(0), acc_count(0), block_start_ms(0),
+      batch_count(0), batch_start_ms(0) {
+    memset(frames, 0, sizeof(frames));
+    memset(acc, 0, sizeof(acc));
+}
+
+void SseHub::set_listeners(int n) {
+    if (n > 0 && listeners == 0) {
+        // Primer suscriptor: el lote empieza limpio
+        acc_count = 0;
+        batch_count = 0;
+    }
+    listeners = n;
+}
+
+void SseHub::add_sample(const SensorData& data) {
+    static_assert(cfg::SSE_BATCH_SAMPLES >= 1 && cfg::SSE_BATCH_SAMPLES <= BATCH_MAX,
+                  "el lote SSE no cabe en un mensaje");
+    if (listeners == 0) return;
+
+    if (acc_count == 0) {
+        acc[0] = acc[1] = acc[2] = 0;
+        block_start_ms = data.timestamp;
+    }
+    acc[0] += data.accel_x;
+    acc[1] += data.accel_y;
+    acc[2] += data.accel_z;
+    if (++acc_count < cfg::SSE_DECIMATION) return;
+
+    // Promedio del bloque: filtro antialias sencillo antes de diezmar
+    if (batch_count == 0) batch_start_ms = block_start_ms;
+    for (int k = 0; k < 3; k++) batch[k][batch_count] = (int16_t)(acc[k] / acc_count);
+    acc_count = 0;
+
+    if (++batch_count >= cfg::SSE_BATCH_SAMPLES) flush_batch();
+}
+
+// {"t":ms,"dt":ms,"cpg":cuentas/g,"ax":[...],"ay":[...],"az":[...]} en cuentas
+void SseHub::flush_batch() {
+    char json[FRAME_MAX];
+    size_t n = (size_t)snprintf(json, sizeof(json), "{\"t\":%llu,\"dt\":%d,\"cpg\":%d",
+                                (unsigned long long)batch_start_ms,
+                                cfg::SSE_DECIMATION * 1000 / cfg::SAMPLE_RATE_HZ,
+                                (int)cfg::ACCEL_SCALE_FACTOR);
+    static const char* const kAxes[3] = {"ax", "ay", "az"};
+    for (int k = 0; k < 3 && n < sizeof(json); k++) {
+        n += (size_t)snprintf(json + n, sizeof(json) - n, ",\"%s\":[", kAxes[k]);
+        for (int i = 0; i < batch_count && n < sizeof(json); i++) {
+            n += (size_t)snprintf(json + n, sizeof(json) - n, i ? ",%d" : "%d", batch[k][i]);
+        }
+        if (n < sizeof(json)) n += (size_t)snprintf(json + n, sizeof(json) - n, "]");
+    }
+    if (n < sizeof(json)) n += (size_t)snprintf(json + n, sizeof(json) - n, "}");
+    batch_count = 0;
+    if (n >= sizeof(json)) return;
+    publish("samples", json);
+}
+
+bool SseHub::publish(const char* event, const char* json) {
+    if (listeners == 0) return false;
+    Frame& f = frames[next_seq % FRAMES];
+    int n = snprintf(f.text, sizeof(f.text), "event: %s\ndata: %s\n\n", event, json);
+    if (n <= 0 || n >= (int)sizeof(f.text)) return false;
+    f.len = (uint16_t)n;
+    next_seq++;
+    return true;
+}
+
+const char* SseHub::frame(uint32_t seq, size_t* len) const {
+    if (seq >= next_seq || seq < oldest()) return nullptr;
+    const Frame& f = frames[seq % FRAMES];
+    *len = f.len;
+    return f.text;
+}
@@ -0,0 +1,65 @@
+#ifndef SSE_HUB_H_
+#define SSE_HUB_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "MPU6050.h"  // Para SensorData
+
+// Mensajes Server-Sent Events para /api/stream.
+//
+// Los productores (SeismicMonitor en core0) publican aquí lotes de muestras
+// decimadas y eventos de disparo ya formateados como "event: ...\ndata:
+// ...\n\n". Los mensajes quedan en un anillo con número de secuencia; cada
+// suscriptor lleva su propio cursor, así un mismo mensaje se formatea una
+// vez y sale por todas las conexiones. Un suscriptor que se queda atrás más
+// de FRAMES mensajes salta al más antiguo que quede.
+class SseHub {
+public:
+    static const int FRAMES = 8;
+    static const size_t FRAME_MAX = 384;
+
+    SseHub();
+
+    // Sin suscriptores no se decima ni se formatea nada
+    void set_listeners(int n);
+    bool active() const { return listeners > 0; }
+
+    // Muestra filtrada a SAMPLE_RATE_HZ. Promedia bloques de
+    // cfg::SSE_DECIMATION y publica un mensaje "samples" cada
+    // cfg::SSE_BATCH_SAMPLES muestras decimadas.
+    void add_sample(const SensorData& data);
+
+    // Publica un mensaje con data ya en JSON. false si no cabe.
+    bool publish(const char* event, const char* json);
+
+    // Secuencias: [oldest(), head()) siguen en el anillo
+    uint32_t head() const { return next_seq; }
+    uint32_t oldest() const { return next_seq > (uint32_t)FRAMES ? next_seq - FRAMES : 0; }
+    const char* frame(uint32_t seq, size_t* len) const;
+
+    uint32_t published() const { return next_seq; }
+
+private:
+    void flush_batch();
+
+    struct Frame {
+        uint16_t len;
+        char text[FRAME_MAX];
+    };
+    Frame frames[FRAMES];
+    uint32_t next_seq;
+    int listeners;
+
+    // Decimación: suma del bloque en curso
+    int32_t acc[3];
+    int acc_count;
+    uint64_t block_start_ms;
+
+    // Lote de muestras decimadas
+    static const int BATCH_MAX = 12;    // peor caso (-32768 por valor) cabe en FRAME_MAX
+    int16_t batch[3][BATCH_MAX];
+    int batch_count;
+    uint64_t batch_start_ms;
+};
+
+#endif // SSE_HUB_H_
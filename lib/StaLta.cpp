@@ -0,0 +1,66 @@
+#include "StaLta.h"
+
+StaLtaDetector::StaLtaDetector(const Config& config) : cfg(config) {
+    if (cfg.sta_samples == 0) cfg.sta_samples = 1;
+    if (cfg.lta_samples <= cfg.sta_samples) cfg.lta_samples = cfg.sta_samples + 1;
+    sta_alpha_q16 = (int32_t)(65536u / cfg.sta_samples);
+    lta_alpha_q16 = (int32_t)(65536u / cfg.lta_samples);
+    if (lta_alpha_q16 == 0) lta_alpha_q16 = 1;
+    reset();
+}
+
+void StaLtaDetector::reset() {
+    sta_q16 = 0;
+    lta_q16 = 0;
+    samples_seen = 0;
+    lta_eff_q16 = 1;
+    triggers = 0;
+    triggered = false;
+}
+
+StaLtaDetector::Edge StaLtaDetector::update(uint32_t cf) {
+    if (cf > 0x7FFFFF) cf = 0x7FFFFF;
+    int64_t x_q16 = (int64_t)cf << 16;
+
+    // Promedios exponenciales: m += (x - m) / N. Durante el calentamiento
+    // se usa 1/(n+1) (media acumulada) para no arrancar sesgados hacia 0.
+    int32_t sta_alpha = sta_alpha_q16;
+    int32_t lta_alpha = lta_alpha_q16;
+    if (samples_seen < cfg.lta_samples) {
+        int32_t warm = (int32_t)(65536u / (samples_seen + 1));
+        if (warm > sta_alpha) sta_alpha = warm;
+        if (warm > lta_alpha) lta_alpha = warm;
+    }
+    sta_q16 += ((x_q16 - sta_q16) * sta_alpha) >> 16;
+    if (!triggered) {
+        lta_q16 += ((x_q16 - lta_q16) * lta_alpha) >> 16;
+    }
+
+    if (samples_seen < cfg.lta_samples) {
+        // Calentamiento: la LTA aún no representa el ruido de fondo
+        samples_seen++;
+        return NONE;
+    }
+
+    int64_t lta_floor_q16 = (int64_t)cfg.min_lta << 16;
+    lta_eff_q16 = lta_q16 > lta_floor_q16 ? lta_q16 : lta_floor_q16;
+    if (lta_eff_q16 <= 0) lta_eff_q16 = 1;
+
+    // STA/LTA >= R  <=>  STA·256 >= LTA·R(Q8): sin divisiones por muestra
+    int64_t sta_scaled = sta_q16 << 8;
+    if (!triggered && sta_scaled >= lta_eff_q16 * cfg.trigger_ratio_q8) {
+        triggered = true;
+        triggers++;
+        return TRIGGERED;
+    }
+    if (triggered && sta_scaled <= lta_eff_q16 * cfg.detrigger_ratio_q8) {
+        triggered = false;
+        return DETRIGGERED;
+    }
+    return NONE;
+}
+
+uint32_t StaLtaDetector::ratio_q8() const {
+    if (samples_seen < cfg.lta_samples || sta_q16 <= 0) return 0;
+    return (uint32_t)((sta_q16 << 8) / lta_eff_q16);
+}
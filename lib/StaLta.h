@@ -0,0 +1,62 @@
+#ifndef STA_LTA_H_
+#define STA_LTA_H_
+
+#include <cstdint>
+#include "../Config.h"
+
+// Detector STA/LTA recursivo (relación entre promedio corto y largo).
+// Cada muestra se procesa en O(1) con aritmética entera: los promedios se
+// guardan en Q16 (int64, para que 1/N pequeños no se queden en cero) y los
+// coeficientes 1/N en Q16. La LTA se congela mientras
+// el detector está disparado para que el propio evento no la infle.
+class StaLtaDetector {
+public:
+    struct Config {
+        uint32_t sta_samples;        // ventana corta (muestras)
+        uint32_t lta_samples;        // ventana larga (muestras)
+        uint32_t trigger_ratio_q8;   // STA/LTA para disparar (Q8)
+        uint32_t detrigger_ratio_q8; // STA/LTA para rearmar (Q8)
+        uint32_t min_lta;            // suelo de la LTA (cuentas), evita ratios enormes en reposo
+    };
+
+    enum Edge { NONE, TRIGGERED, DETRIGGERED };
+
+    explicit StaLtaDetector(const Config& config);
+
+    // Alimentar una muestra de la función característica (cuentas >= 0).
+    // Devuelve el flanco si el estado cambió con esta muestra.
+    Edge update(uint32_t cf);
+
+    void reset();
+
+    bool is_triggered() const { return triggered; }
+    bool is_warmed_up() const { return samples_seen >= cfg.lta_samples; }
+    uint32_t ratio_q8() const;  // calculado bajo demanda (división)
+    uint32_t sta() const { return (uint32_t)(sta_q16 >> 16); }
+    uint32_t lta() const { return (uint32_t)(lta_q16 >> 16); }
+    uint32_t trigger_count() const { return triggers; }
+
+private:
+    Config cfg;
+    int32_t sta_alpha_q16;
+    int32_t lta_alpha_q16;
+    int64_t sta_q16;
+    int64_t lta_q16;
+    uint32_t samples_seen;
+    int64_t lta_eff_q16;
+    uint32_t triggers;
+    bool triggered;
+};
+
+// Configuración por defecto a partir de Config.h (evaluada en compilación)
+constexpr StaLtaDetector::Config default_sta_lta_config() {
+    return StaLtaDetector::Config{
+        (uint32_t)(cfg::STA_WINDOW_S * cfg::SAMPLE_RATE_HZ),
+        (uint32_t)(cfg::LTA_WINDOW_S * cfg::SAMPLE_RATE_HZ),
+        (uint32_t)(cfg::STA_LTA_TRIGGER_RATIO * 256.0f),
+        (uint32_t)(cfg::STA_LTA_DETRIGGER_RATIO * 256.0f),
+        (uint32_t)(cfg::STA_LTA_MIN_LTA / cfg::GRAVITY * cfg::ACCEL_SCALE_FACTOR + 0.5f),
+    };
+}
+
+#endif // STA_LTA_H_
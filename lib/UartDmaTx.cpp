@@ -0,0 +1,105 @@
+#include "UartDmaTx.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include <cstdio>
+
+UartDmaTx* UartDmaTx::instance = nullptr;
+
+UartDmaTx::UartDmaTx()
+    : uart(nullptr), channel(-1), segment_count(0), current(0), active(false),
+      done_cb(nullptr), done_ctx(nullptr), total_bytes(0), total_transfers(0) {
+}
+
+bool UartDmaTx::begin(uart_inst_t* u) {
+    if (channel >= 0) return true;
+
+    int ch = dma_claim_unused_channel(false);
+    if (ch < 0) {
+        printf("[DMA] Sin canales libres; TX por UART bloqueante\n");
+        return false;
+    }
+    uart = u;
+    channel = ch;
+    instance = this;
+
+    dma_channel_config c = dma_channel_get_default_config(channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, uart_get_dreq(uart, true));
+    dma_channel_configure(channel, &c, &uart_get_hw(uart)->dr, nullptr, 0, false);
+
+    dma_channel_set_irq1_enabled(channel, true);
+    irq_add_shared_handler(DMA_IRQ_1, dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    printf("[DMA] TX UART por DMA en canal %d\n", channel);
+    return true;
+}
+
+bool UartDmaTx::send(const TxSegment* segs, int count, DoneCallback cb, void* ctx) {
+    if (channel < 0 || active || count <= 0 || count > MAX_SEGMENTS) return false;
+
+    segment_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (segs[i].len > 0) segments[segment_count++] = segs[i];
+    }
+    done_cb = cb;
+    done_ctx = ctx;
+    current = 0;
+    total_transfers = total_transfers + 1;
+
+    if (segment_count == 0) {
+        if (done_cb) done_cb(done_ctx);
+        return true;
+    }
+
+    active = true;
+    start_segment();
+    return true;
+}
+
+void UartDmaTx::start_segment() {
+    const TxSegment& s = segments[current];
+    dma_channel_transfer_from_buffer_now(channel, s.data, (uint32_t)s.len);
+}
+
+void UartDmaTx::dma_irq_handler() {
+    if (instance && instance->channel >= 0 && dma_channel_get_irq1_status(instance->channel)) {
+        dma_channel_acknowledge_irq1(instance->channel);
+        instance->on_irq();
+    }
+}
+
+void UartDmaTx::on_irq() {
+    if (!active) return;
+    total_bytes = total_bytes + (uint32_t)segments[current].len;
+
+    if (current + 1 < segment_count) {
+        current = current + 1;
+        start_segment();
+        return;
+    }
+
+    active = false;
+    if (done_cb) done_cb(done_ctx);
+    __sev();
+}
+
+bool UartDmaTx::wait_done(absolute_time_t deadline) {
+    while (active) {
+        if (time_reached(deadline)) return false;
+        best_effort_wfe_or_timeout(deadline);
+    }
+    return true;
+}
+
+void UartDmaTx::abort() {
+    if (channel < 0 || !active) return;
+    // dma_channel_abort() puede dejar la IRQ pendiente: se desactiva antes
+    dma_channel_set_irq1_enabled(channel, false);
+    dma_channel_abort(channel);
+    dma_channel_acknowledge_irq1(channel);
+    dma_channel_set_irq1_enabled(channel, true);
+    active = false;
+}
@@ -0,0 +1,62 @@
+#ifndef UART_DMA_TX_H_
+#define UART_DMA_TX_H_
+
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include <cstddef>
+
+// Tramo de datos a transmitir. Los datos deben seguir vivos hasta que
+// termine la transferencia (busy() == false).
+struct TxSegment {
+    const void* data;
+    size_t len;
+};
+
+// Motor de transmisión UART por DMA. Encadena varios tramos (cabecera,
+// cuerpo, ...) desde la ISR del DMA; la CPU queda libre mientras tanto.
+class UartDmaTx {
+public:
+    static const int MAX_SEGMENTS = 4;
+    using DoneCallback = void (*)(void* ctx);
+
+    UartDmaTx();
+
+    // Reserva un canal DMA ligado al DREQ de TX del UART.
+    bool begin(uart_inst_t* uart);
+
+    // Arranca la transmisión de los tramos. Devuelve false si el motor está
+    // ocupado, no se inicializó o hay demasiados tramos. El callback (opcional)
+    // se llama desde la ISR al terminar.
+    bool send(const TxSegment* segs, int count, DoneCallback cb = nullptr, void* ctx = nullptr);
+
+    bool ready() const { return channel >= 0; }
+    bool busy() const { return active; }
+
+    // Espera (WFE) a que termine la transferencia. false si vence el plazo.
+    bool wait_done(absolute_time_t deadline);
+
+    // Cancela la transferencia en curso.
+    void abort();
+
+    uint32_t bytes_sent() const { return total_bytes; }
+    uint32_t transfers() const { return total_transfers; }
+
+private:
+    static void dma_irq_handler();
+    static UartDmaTx* instance;
+    void on_irq();
+    void start_segment();
+
+    uart_inst_t* uart;
+    int channel;
+    TxSegment segments[MAX_SEGMENTS];
+    int segment_count;
+    volatile int current;
+    volatile bool active;
+    DoneCallback done_cb;
+    void* done_ctx;
+    volatile uint32_t total_bytes;
+    volatile uint32_t total_transfers;
+};
+
+#endif // UART_DMA_TX_H_
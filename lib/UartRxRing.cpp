@@ -0,0 +1,54 @@
+#include "UartRxRing.h"
+#include "hardware/irq.h"
+#include <cstdio>
+
+UartRxRing* UartRxRing::instances[2] = {nullptr, nullptr};
+
+UartRxRing::UartRxRing() : uart(nullptr), hw_overruns(0), framing_errors(0), max_fill(0) {
+}
+
+bool UartRxRing::begin(uart_inst_t* u) {
+    uint index = uart_get_index(u);
+    if (index > 1) return false;
+
+    uart = u;
+    instances[index] = this;
+
+    int irq = (index == 0) ? UART0_IRQ : UART1_IRQ;
+    irq_set_exclusive_handler(irq, (index == 0) ? irq_handler_uart0 : irq_handler_uart1);
+    irq_set_enabled(irq, true);
+
+    // RX + timeout de recepción: la ISR salta aunque la FIFO no llegue al umbral
+    uart_set_irq_enables(uart, true, false);
+    printf("[UART] Buffer RX por interrupción activo (%u bytes)\n", (unsigned)SIZE);
+    return true;
+}
+
+void UartRxRing::irq_handler_uart0() { if (instances[0]) instances[0]->on_irq(); }
+void UartRxRing::irq_handler_uart1() { if (instances[1]) instances[1]->on_irq(); }
+
+void UartRxRing::on_irq() {
+    uart_hw_t* hw = uart_get_hw(uart);
+    while (!(hw->fr & UART_UARTFR_RXFE_BITS)) {
+        uint32_t dr = hw->dr;
+        if (dr & UART_UARTDR_OE_BITS) hw_overruns = hw_overruns + 1;
+        if (dr & UART_UARTDR_FE_BITS) framing_errors = framing_errors + 1;
+        ring.push((uint8_t)dr);
+    }
+    uint32_t fill = ring.size();
+    if (fill > max_fill) max_fill = fill;
+}
+
+int UartRxRing::getc() {
+    uint8_t c;
+    return ring.pop(c) ? (int)c : -1;
+}
+
+bool UartRxRing::wait_for_data(absolute_time_t deadline) {
+    while (ring.empty()) {
+        if (time_reached(deadline)) return false;
+        // La ISR (o la alarma del plazo) nos despierta
+        best_effort_wfe_or_timeout(deadline);
+    }
+    return true;
+}
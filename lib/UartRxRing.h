@@ -0,0 +1,50 @@
+#ifndef UART_RX_RING_H_
+#define UART_RX_RING_H_
+
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "SpscQueue.h"
+
+// Buffer circular de recepción UART alimentado por interrupción.
+// La ISR vacía la FIFO hardware (32 bytes) en cuanto hay datos, así no se
+// pierden bytes aunque la CPU esté ocupada (p. ej. en un printf por USB).
+class UartRxRing {
+public:
+    static const uint32_t SIZE = 2048;
+
+    UartRxRing();
+
+    // Instala la ISR de RX para el UART indicado (ya inicializado).
+    bool begin(uart_inst_t* uart);
+
+    // Siguiente byte o -1 si el buffer está vacío. No bloquea.
+    int getc();
+
+    // Bytes pendientes de leer.
+    uint32_t available() const { return ring.size(); }
+
+    // Duerme (WFE) hasta que llegue algún byte o venza el plazo.
+    // Devuelve true si hay datos disponibles.
+    bool wait_for_data(absolute_time_t deadline);
+
+    // Contadores de pérdidas
+    uint32_t overflow_count() const { return ring.dropped_count(); }  // buffer lleno
+    uint32_t hw_overrun_count() const { return hw_overruns; }         // FIFO desbordada
+    // Bytes con error de trama: ruido o el otro extremo a otra velocidad
+    uint32_t framing_error_count() const { return framing_errors; }
+    uint32_t high_water() const { return max_fill; }
+
+private:
+    static void irq_handler_uart0();
+    static void irq_handler_uart1();
+    static UartRxRing* instances[2];
+    void on_irq();
+
+    uart_inst_t* uart;
+    SpscQueue<uint8_t, SIZE> ring;
+    volatile uint32_t hw_overruns;
+    volatile uint32_t framing_errors;
+    volatile uint32_t max_fill;
+};
+
+#endif // UART_RX_RING_H_
@@ -0,0 +1,179 @@
+#include "UplinkQueue.h"
+#include <cstring>
+
+// Política de cada clase. Alertas y formas de onda no se pisan ni caducan
+// (con diario en flash, además, sobreviven a reinicios); telemetría y
+// estado valen menos cuanto más viejos, así que se pisan y se abandonan
+// pronto.
+static const UplinkQueue::Policy kPolicies[UplinkQueue::NUM_CLASSES] = {
+    // huecos, bytes, pisar, intentos, espera, tope
+    {cfg::UPLINK_ALERT_SLOTS,     cfg::UPLINK_ALERT_BYTES,  false, 0,   500, 30000},
+    {cfg::UPLINK_WAVEFORM_SLOTS,  cfg::BATCH_BUFFER_SIZE,   false, 0,  2000, 60000},
+    {cfg::UPLINK_TELEMETRY_SLOTS, cfg::BATCH_BUFFER_SIZE,   true,  3,  1000,  8000},
+    {cfg::UPLINK_STATUS_SLOTS,    cfg::UPLINK_STATUS_BYTES, true,  2,  5000, 30000},
+};
+
+static_assert(cfg::UPLINK_ALERT_SLOTS > 0 && cfg::UPLINK_WAVEFORM_SLOTS > 0 &&
+              cfg::UPLINK_TELEMETRY_SLOTS > 1 && cfg::UPLINK_STATUS_SLOTS > 0,
+              "cada clase necesita huecos (telemetría: uno se llena mientras otro sale)");
+
+// El mensaje más antiguo gana; el orden es un contador que puede dar la vuelta
+static inline bool older(const UplinkQueue::Message& a, const UplinkQueue::Message& b) {
+    return (int32_t)(a.order - b.order) < 0;
+}
+
+static inline bool reached(uint32_t now, uint32_t at) {
+    return (int32_t)(now - at) >= 0;
+}
+
+UplinkQueue::UplinkQueue() : rng(0x9E3779B9u) {
+    memset(messages, 0, sizeof(messages));
+    memset(next_order, 0, sizeof(next_order));
+    memset(not_before, 0, sizeof(not_before));
+    memset(class_stats, 0, sizeof(class_stats));
+
+    int m = 0;
+    size_t used = 0;
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        const Policy& p = kPolicies[c];
+        first[c] = (uint8_t)m;
+        for (int i = 0; i < p.slots; i++, m++) {
+            messages[m].body = arena + used;
+            messages[m].capacity = p.slot_size;
+            messages[m].cls = (Class)c;
+            messages[m].state = FREE;
+            used += p.slot_size;
+        }
+    }
+}
+
+const UplinkQueue::Policy& UplinkQueue::policy(Class c) {
+    return kPolicies[c];
+}
+
+const char* UplinkQueue::class_name(Class c) {
+    static const char* const kNames[NUM_CLASSES] = {"alerta", "forma de onda", "telemetría", "estado"};
+    return c < NUM_CLASSES ? kNames[c] : "?";
+}
+
+UplinkQueue::Message* UplinkQueue::reserve(Class c) {
+    const Policy& p = kPolicies[c];
+    Message* victim = nullptr;
+    for (int i = first[c]; i < first[c] + p.slots; i++) {
+        Message& m = messages[i];
+        if (m.state == FREE) {
+            victim = &m;
+            break;
+        }
+        if (p.drop_oldest && m.state == QUEUED && (!victim || older(m, *victim))) victim = &m;
+    }
+    if (!victim) return nullptr;
+
+    if (victim->state == QUEUED) class_stats[c].dropped++;
+    free_slot(victim);
+    victim->state = FILLING;
+    return victim;
+}
+
+void UplinkQueue::commit(Message* m, size_t len, const char* path, const char* content_type) {
+    m->len = (uint16_t)(len < m->capacity ? len : m->capacity);
+    m->path = path;
+    m->content_type = content_type;
+    m->attempts = 0;
+    m->order = next_order[m->cls]++;
+    m->state = QUEUED;
+    class_stats[m->cls].queued++;
+}
+
+bool UplinkQueue::has_room(Class c) const {
+    const Policy& p = kPolicies[c];
+    for (int i = first[c]; i < first[c] + p.slots; i++) {
+        State s = messages[i].state;
+        if (s == FREE || (p.drop_oldest && s == QUEUED)) return true;
+    }
+    return false;
+}
+
+UplinkQueue::Message* UplinkQueue::next(uint32_t now_ms) {
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        if (!reached(now_ms, not_before[c])) continue;   // esperando a reintentar
+        Message* best = nullptr;
+        for (int i = first[c]; i < first[c] + kPolicies[c].slots; i++) {
+            Message& m = messages[i];
+            if (m.state == QUEUED && (!best || older(m, *best))) best = &m;
+        }
+        if (best) {
+            best->state = IN_FLIGHT;
+            return best;
+        }
+    }
+    return nullptr;
+}
+
+void UplinkQueue::requeue(Message* m) {
+    if (m->state == IN_FLIGHT) m->state = QUEUED;
+}
+
+UplinkQueue::Outcome UplinkQueue::complete(Message* m, bool success, int http_status, uint32_t now_ms) {
+    Class c = m->cls;
+    Stats& st = class_stats[c];
+
+    if (success) {
+        st.sent++;
+        not_before[c] = now_ms;
+        free_slot(m);
+        return SENT;
+    }
+
+    m->attempts++;
+    const Policy& p = kPolicies[c];
+    bool rejected = http_status >= 400 && http_status < 500;
+    if (rejected || (p.max_attempts > 0 && m->attempts >= p.max_attempts)) {
+        st.expired++;
+        free_slot(m);
+        return DROPPED;
+    }
+
+    st.retries++;
+    m->state = QUEUED;
+    not_before[c] = now_ms + backoff(c, m->attempts);
+    return RETRY;
+}
+
+int UplinkQueue::depth(Class c) const {
+    int n = 0;
+    for (int i = first[c]; i < first[c] + kPolicies[c].slots; i++) {
+        if (messages[i].state == QUEUED || messages[i].state == IN_FLIGHT) n++;
+    }
+    return n;
+}
+
+void UplinkQueue::free_slot(Message* m) {
+    m->state = FREE;
+    m->len = 0;
+    m->attempts = 0;
+    m->path = nullptr;
+    m->content_type = nullptr;
+    m->journal_offset = 0;
+    m->journal_seq = 0;
+}
+
+// Espera exponencial con jitter: la mitad fija y la otra mitad al azar, para
+// que los reintentos de varios equipos tras un corte no lleguen a la vez
+uint32_t UplinkQueue::backoff(Class c, uint8_t attempts) {
+    const Policy& p = kPolicies[c];
+    uint32_t b = p.backoff_max_ms;
+    if (attempts > 0 && attempts <= 16) {
+        uint32_t exp = p.backoff_ms << (attempts - 1);
+        if (exp < b) b = exp;
+    }
+    return b / 2 + random() % (b / 2 + 1);
+}
+
+// xorshift32: suficiente para repartir reintentos
+uint32_t UplinkQueue::random() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
@@ -0,0 +1,111 @@
+#ifndef UPLINK_QUEUE_H_
+#define UPLINK_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "../Config.h"
+
+// Cola de salida hacia el API, en RAM y de tamaño fijo.
+//
+// Cada mensaje pertenece a una clase de prioridad: ALERT (eventos) adelanta
+// a WAVEFORM (formas de onda), que adelanta a TELEMETRY (lotes continuos),
+// que adelanta a STATUS. Como el cliente HTTP lleva una petición a la vez,
+// "adelantar" significa que en cuanto acaba la que está en vuelo sale el
+// mensaje listo de la clase más alta; una clase en espera de reintento no
+// bloquea a las de abajo.
+//
+// Cada clase tiene sus huecos con el cuerpo dentro (sin memoria dinámica) y
+// su política: intentos máximos, espera exponencial con jitter tras cada
+// fallo y, para las clases bajas, pisar el mensaje más antiguo cuando no
+// queda hueco. Un 4xx no se reintenta.
+class UplinkQueue {
+public:
+    enum Class : uint8_t { ALERT, WAVEFORM, TELEMETRY, STATUS, NUM_CLASSES };
+
+    struct Policy {
+        uint8_t slots;
+        uint16_t slot_size;         // bytes de cuerpo por hueco
+        bool drop_oldest;           // sin hueco: se pisa el más antiguo en espera
+        uint8_t max_attempts;       // 0 = sin límite
+        uint32_t backoff_ms;        // espera tras el primer fallo
+        uint32_t backoff_max_ms;    // tope de la espera
+    };
+
+    enum State : uint8_t { FREE, FILLING, QUEUED, IN_FLIGHT };
+
+    struct Message {
+        // Lo rellena el productor entre reserve() y commit()
+        uint8_t* body;
+        uint16_t capacity;
+        uint16_t len;
+        const char* path;
+        const char* content_type;
+        uint32_t journal_offset;    // registro del diario en flash
+        uint32_t journal_seq;       // 0 = el mensaje solo vive en RAM
+
+        // Estado de la cola
+        Class cls;
+        State state;
+        uint8_t attempts;
+        uint32_t order;             // orden de llegada dentro de la clase
+    };
+
+    enum Outcome : uint8_t { SENT, RETRY, DROPPED };
+
+    struct Stats {
+        uint32_t queued;
+        uint32_t sent;
+        uint32_t retries;
+        uint32_t dropped;           // pisados por falta de hueco
+        uint32_t expired;           // sin más intentos o rechazados (4xx)
+    };
+
+    UplinkQueue();
+
+    static const Policy& policy(Class c);
+    static const char* class_name(Class c);
+
+    // Semilla del jitter (p. ej. el reloj al arrancar)
+    void seed(uint32_t s) { rng = s ? s : 1; }
+
+    // Hueco para escribir un cuerpo. nullptr si la clase está llena y no
+    // admite pisar mensajes.
+    Message* reserve(Class c);
+    void commit(Message* m, size_t len, const char* path, const char* content_type);
+    bool has_room(Class c) const;
+
+    // Siguiente mensaje a enviar (pasa a IN_FLIGHT) o nullptr
+    Message* next(uint32_t now_ms);
+    // No se pudo entregar al cliente HTTP: vuelve a la cola sin gastar intento
+    void requeue(Message* m);
+    // Resultado del envío; con SENT y DROPPED el hueco queda libre
+    Outcome complete(Message* m, bool success, int http_status, uint32_t now_ms);
+
+    int depth(Class c) const;
+    const Stats& stats(Class c) const { return class_stats[c]; }
+
+private:
+    static constexpr int TOTAL_SLOTS =
+        cfg::UPLINK_ALERT_SLOTS + cfg::UPLINK_WAVEFORM_SLOTS +
+        cfg::UPLINK_TELEMETRY_SLOTS + cfg::UPLINK_STATUS_SLOTS;
+    static constexpr size_t ARENA_SIZE =
+        (size_t)cfg::UPLINK_ALERT_SLOTS * cfg::UPLINK_ALERT_BYTES +
+        (size_t)cfg::UPLINK_WAVEFORM_SLOTS * cfg::BATCH_BUFFER_SIZE +
+        (size_t)cfg::UPLINK_TELEMETRY_SLOTS * cfg::BATCH_BUFFER_SIZE +
+        (size_t)cfg::UPLINK_STATUS_SLOTS * cfg::UPLINK_STATUS_BYTES;
+
+    void free_slot(Message* m);
+    uint32_t backoff(Class c, uint8_t attempts);
+    uint32_t random();
+
+    Message messages[TOTAL_SLOTS];
+    uint8_t first[NUM_CLASSES];         // primer hueco de cada clase en messages[]
+    uint32_t next_order[NUM_CLASSES];
+    uint32_t not_before[NUM_CLASSES];   // ms; la clase espera a reintentar
+    Stats class_stats[NUM_CLASSES];
+    uint32_t rng;
+
+    uint8_t arena[ARENA_SIZE];
+};
+
+#endif // UPLINK_QUEUE_H_
@@ -0,0 +1,86 @@
+#include "WindowStats.h"
+#include "FixedPoint.h"
+#include <cstring>
+
+WindowStats::WindowStats(uint32_t samples_per_block)
+    : block_samples(samples_per_block > 0 ? samples_per_block : 1) {
+    reset();
+}
+
+void WindowStats::reset() {
+    memset(blocks, 0, sizeof(blocks));
+    head = 0;
+    filled = 0;
+    cur = Block{0, 0, INT32_MIN, INT32_MAX, 0};
+    total_sum = 0;
+    total_sum_sq = 0;
+    total_count = 0;
+    blocks_max = INT32_MIN;
+    blocks_min = INT32_MAX;
+}
+
+void WindowStats::add(int32_t v) {
+    cur.sum += v;
+    cur.sum_sq += (uint64_t)((int64_t)v * v);
+    if (v > cur.max) cur.max = v;
+    if (v < cur.min) cur.min = v;
+    if (++cur.count >= block_samples) close_block();
+}
+
+void WindowStats::close_block() {
+    // Sustituir el bloque más antiguo por el recién cerrado
+    Block& old = blocks[head];
+    if (filled == BLOCKS) {
+        total_sum -= old.sum;
+        total_sum_sq -= old.sum_sq;
+        total_count -= old.count;
+    } else {
+        filled++;
+    }
+    old = cur;
+    total_sum += cur.sum;
+    total_sum_sq += cur.sum_sq;
+    total_count += cur.count;
+    head = (head + 1) % BLOCKS;
+
+    // Pico y mínimo: BLOCKS comparaciones cada block_samples muestras
+    blocks_max = INT32_MIN;
+    blocks_min = INT32_MAX;
+    for (int i = 0; i < filled; i++) {
+        if (blocks[i].max > blocks_max) blocks_max = blocks[i].max;
+        if (blocks[i].min < blocks_min) blocks_min = blocks[i].min;
+    }
+
+    cur = Block{0, 0, INT32_MIN, INT32_MAX, 0};
+}
+
+int32_t WindowStats::mean() const {
+    uint32_t n = count();
+    return n ? (int32_t)(sum() / (int64_t)n) : 0;
+}
+
+uint32_t WindowStats::variance() const {
+    uint32_t n = count();
+    if (n == 0) return 0;
+    int64_t m = sum() / (int64_t)n;
+    uint64_t mean_sq = (total_sum_sq + cur.sum_sq) / n;
+    int64_t var = (int64_t)mean_sq - m * m;
+    return var > 0 ? (uint32_t)var : 0;
+}
+
+uint32_t WindowStats::rms() const {
+    uint32_t n = count();
+    if (n == 0) return 0;
+    uint64_t mean_sq = (total_sum_sq + cur.sum_sq) / n;
+    return fx::isqrt32(mean_sq > UINT32_MAX ? UINT32_MAX : (uint32_t)mean_sq);
+}
+
+int32_t WindowStats::peak() const {
+    if (count() == 0) return 0;
+    return cur.max > blocks_max ? cur.max : blocks_max;
+}
+
+int32_t WindowStats::min() const {
+    if (count() == 0) return 0;
+    return cur.min < blocks_min ? cur.min : blocks_min;
+}
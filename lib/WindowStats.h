@@ -0,0 +1,75 @@
+#ifndef WINDOW_STATS_H_
+#define WINDOW_STATS_H_
+
+#include <cstdint>
+#include "../Config.h"
+
+// Estadísticas de ventana deslizante actualizadas en O(1) por muestra.
+//
+// La ventana se parte en BLOCKS bloques de block_samples muestras. Cada bloque
+// guarda suma, suma de cuadrados, máximo y mínimo; al cerrarse un bloque se
+// descuenta el más antiguo de los acumulados. El pico y el mínimo se rehacen
+// sobre los BLOCKS agregados solo al cerrar un bloque, así que el coste por
+// muestra es constante (amortizado). La ventana efectiva cubre los BLOCKS
+// bloques completos más el bloque en curso.
+class WindowStats {
+public:
+    static const int BLOCKS = 10;
+
+    explicit WindowStats(uint32_t block_samples);
+
+    void add(int32_t v);
+    void reset();
+
+    uint32_t count() const { return total_count + cur.count; }
+    int64_t  sum() const { return total_sum + cur.sum; }
+
+    // Calculadas bajo demanda (solo al informar)
+    int32_t  mean() const;
+    uint32_t variance() const;    // unidades²
+    uint32_t rms() const;
+    int32_t  peak() const;
+    int32_t  min() const;
+
+    uint32_t window_samples() const { return block_samples * (BLOCKS + 1); }
+
+private:
+    struct Block {
+        int64_t  sum;
+        uint64_t sum_sq;
+        int32_t  max;
+        int32_t  min;
+        uint32_t count;
+    };
+
+    void close_block();
+
+    uint32_t block_samples;
+    Block blocks[BLOCKS];   // bloques completos (anillo)
+    int head;               // siguiente bloque a sobrescribir
+    int filled;
+    Block cur;              // bloque en curso
+
+    // Acumulados de los bloques completos
+    int64_t  total_sum;
+    uint64_t total_sum_sq;
+    uint32_t total_count;
+    int32_t  blocks_max;
+    int32_t  blocks_min;
+};
+
+// Las tres ventanas que informa el monitor (1 s, 10 s y 60 s)
+struct MagnitudeStats {
+    WindowStats w1s;
+    WindowStats w10s;
+    WindowStats w60s;
+
+    MagnitudeStats()
+        : w1s(cfg::SAMPLE_RATE_HZ * 1 / WindowStats::BLOCKS),
+          w10s(cfg::SAMPLE_RATE_HZ * 10 / WindowStats::BLOCKS),
+          w60s(cfg::SAMPLE_RATE_HZ * 60 / WindowStats::BLOCKS) {}
+
+    void add(int32_t v) { w1s.add(v); w10s.add(v); w60s.add(v); }
+};
+
+#endif // WINDOW_STATS_H_
@@ -2,6 +2,9 @@
 #include "lib/Esp8266HttpServer.h"
 #include "lib/MPU6050.h"
 #include "lib/SeismicMonitor.h"
+#include "lib/Scheduler.h"
+#include "lib/FixedPoint.h"
+#include "lib/Log.h"
 #include "hardware/i2c.h"
 #include <cstdio>
 
@@ -26,6 +29,12 @@ int main() {
     uart_init(cfg::UART(), cfg::UART_BAUD);
     gpio_set_function(cfg::UART_TX_PIN, GPIO_FUNC_UART);
     gpio_set_function(cfg::UART_RX_PIN, GPIO_FUNC_UART);
+    // RTS/CTS quedan asignados al UART; el control de flujo se activa en
+    // begin() cuando el ESP lo acepta
+    if (cfg::UART_CTS_PIN >= 0 && cfg::UART_RTS_PIN >= 0) {
+        gpio_set_function(cfg::UART_CTS_PIN, GPIO_FUNC_UART);
+        gpio_set_function(cfg::UART_RTS_PIN, GPIO_FUNC_UART);
+    }
     uart_set_format(cfg::UART(), 8, 1, UART_PARITY_NONE);
     uart_set_fifo_enabled(cfg::UART(), true);
 
@@ -33,15 +42,17 @@ int main() {
     
     // 1. Sensor MPU6050
     printf("Inicializando sensor MPU6050...\n");
-    MPU6050 mpu_sensor(i2c0, cfg::MPU6050_ADDR);
+    // Objetos estáticos: el monitor guarda los registros de captura y no
+    // cabe en la pila de main
+    static MPU6050 mpu_sensor(i2c0, cfg::MPU6050_ADDR);
     
     // 2. Servidor HTTP ESP8266
     printf("Inicializando servidor ESP8266...\n");
-    Esp8266HttpServer server;
+    static Esp8266HttpServer server;
     
     // 3. Monitor sísmico
     printf("Inicializando monitor sísmico...\n");
-    SeismicMonitor seismic_monitor(&mpu_sensor, &server);
+    static SeismicMonitor seismic_monitor(&mpu_sensor, &server);
     
     // ===== Inicialización del ESP8266 =====
     if (!server.begin()) {
@@ -55,45 +66,99 @@ int main() {
     printf("ESP8266 inicializado correctamente\n");
     
     // ===== Inicialización del monitor sísmico =====
-    if (!seismic_monitor.init()) {
+    bool monitor_ok = seismic_monitor.init();
+    if (!monitor_ok) {
         printf("Error: No se pudo inicializar el monitor sísmico\n");
         printf("Continuando solo con servidor HTTP...\n");
     } else {
         printf("Monitor sísmico inicializado correctamente\n");
     }
     
+    if (cfg::RUN_FIXED_POINT_BENCH) {
+        fx::run_conversion_benchmark();
+    }
+    
     printf("\n===== SISTEMA LISTO =====\n");
     printf("Servidor HTTP: puerto %d\n", cfg::HTTP_PORT);
     printf("API destino: %s:%d%s\n", cfg::API_HOST, cfg::API_PORT, cfg::API_ENDPOINT);
-    printf("Intervalo de lectura: %d ms\n", cfg::SENSOR_READ_INTERVAL);
+    printf("Muestreo: %d Hz (FIFO vaciada cada %d ms)\n", cfg::SAMPLE_RATE_HZ, cfg::SENSOR_READ_INTERVAL);
+    printf("Adquisición: %s\n", (cfg::DUAL_CORE && monitor_ok) ? "core1" : "core0 (planificador)");
     printf("Envío de eventos: cada evento significativo\n");
     printf("Envío de estado: cada %d ms\n", cfg::STATUS_SEND_INTERVAL);
     printf("========================\n\n");
 
-    // ===== Bucle principal =====
-    uint64_t last_status_print = 0;
-    const uint64_t STATUS_PRINT_INTERVAL = 60000; // Cada minuto
-    
-    while (true) {
-        // 1. Procesar servidor HTTP (requests entrantes)
-        server.loop();
-        
-        // 2. Procesar monitor sísmico (lectura de sensor y envío de datos)
-        seismic_monitor.loop();
-        
-        // 3. Actualizar datos del sensor en el servidor para API
-        server.set_sensor_data(seismic_monitor.get_current_sensor_data(), seismic_monitor.is_sensor_ok());
-        
-        // 4. Imprimir estado cada minuto (opcional, para debug)
-        uint64_t current_time = to_ms_since_boot(get_absolute_time());
-        if (current_time - last_status_print >= STATUS_PRINT_INTERVAL) {
-            seismic_monitor.print_sensor_status();
-            last_status_print = current_time;
-        }
-        
-        // 5. Pequeña pausa para no saturar el CPU
-        sleep_ms(10);
+    // ===== Bucle principal (planificador cooperativo) =====
+    // Cada subsistema avanza un paso acotado por vuelta; así el servidor
+    // HTTP ya no acapara la CPU y el muestreo mantiene su cadencia.
+    static Scheduler scheduler;
+    
+    struct App {
+        Esp8266HttpServer* server;
+        SeismicMonitor* monitor;
+    };
+    static App app = { &server, &seismic_monitor };
+    
+    // 1. Procesar servidor HTTP (requests entrantes)
+    scheduler.add_task("http", [](void* ctx, uint32_t budget_us) {
+        static_cast<App*>(ctx)->server->poll(budget_us);
+    }, &app, 0, cfg::TASK_HTTP_BUDGET_US);
+    
+    // 2. Leer sensor (salvo que lo haga core1) y actualizar datos del
+    //    servidor para la API
+    if (cfg::DUAL_CORE && monitor_ok) {
+        seismic_monitor.start_acquisition_core1();
+        scheduler.add_task("sensor", [](void* ctx, uint32_t) {
+            App* a = static_cast<App*>(ctx);
+            a->monitor->drain_samples();
+            a->server->set_sensor_data(a->monitor->get_current_sensor_data(), a->monitor->is_sensor_ok());
+        }, &app, cfg::SENSOR_READ_INTERVAL * 1000u, cfg::TASK_SAMPLING_BUDGET_US);
+    } else {
+        scheduler.add_task("sampling", [](void* ctx, uint32_t budget_us) {
+            App* a = static_cast<App*>(ctx);
+            a->monitor->poll_sampling(budget_us);
+            a->monitor->drain_samples();
+            a->server->set_sensor_data(a->monitor->get_current_sensor_data(), a->monitor->is_sensor_ok());
+        }, &app, cfg::SENSOR_READ_INTERVAL * 1000u, cfg::TASK_SAMPLING_BUDGET_US);
     }
     
-    return 0; // Nunca debería llegar aquí
-}
\ No newline at end of file
+    // 3. Envío de eventos y estado al API externo
+    scheduler.add_task("uplink", [](void* ctx, uint32_t budget_us) {
+        static_cast<App*>(ctx)->monitor->poll_uplink(budget_us);
+    }, &app, 0, cfg::TASK_UPLINK_BUDGET_US);
+    
+    // 4. Imprimir estado cada minuto (opcional, para debug)
+    scheduler.add_task("status", [](void* ctx, uint32_t) {
+        App* a = static_cast<App*>(ctx);
+        a->monitor->print_sensor_status();
+        scheduler.print_stats();
+        const UartRxRing& rx = a->server->rx_ring();
+        printf("[UART] %lu baudios%s. RX: desbordes buffer %lu, desbordes FIFO %lu, "
+               "errores de trama %lu, máx ocupación %lu/%lu\n",
+               (unsigned long)a->server->uart_baud(), a->server->uart_flow_control() ? " + RTS/CTS" : "",
+               (unsigned long)rx.overflow_count(), (unsigned long)rx.hw_overrun_count(),
+               (unsigned long)rx.framing_error_count(),
+               (unsigned long)rx.high_water(), (unsigned long)UartRxRing::SIZE);
+        const AsyncHttpClient& http = a->server->http_client();
+        printf("[API] Enlace %s, %lu conexiones para %lu peticiones, %lu fallos, último estado %d, "
+               "latencia última %lu ms / máx %lu ms\n",
+               http.connected() ? "abierto" : "cerrado",
+               (unsigned long)http.connect_count(), (unsigned long)http.request_count(),
+               (unsigned long)http.failure_count(), http.last_status(),
+               (unsigned long)(http.last_latency_us() / 1000), (unsigned long)(http.max_latency_us() / 1000));
+        printf("[SSE] %lu mensajes publicados, %lu saltados por suscriptores lentos, %lu suscripciones rechazadas\n",
+               (unsigned long)a->server->live_stream().published(),
+               (unsigned long)a->server->stream_skipped(), (unsigned long)a->server->stream_rejected());
+        printf("[LOG] %lu registros impresos, %lu pendientes, %lu perdidos (anillo lleno)\n",
+               (unsigned long)Log::printed(), (unsigned long)Log::pending(), (unsigned long)Log::dropped());
+    }, &app, cfg::STATUS_PRINT_INTERVAL * 1000u, UINT32_MAX); // sin presupuesto: solo debug
+    
+    // 5. Log diferido: la última tarea, formatea lo que dejaron las demás
+    //    (y core1) con el tiempo que sobra
+    scheduler.add_task("log", [](void*, uint32_t budget_us) {
+        Log::drain(budget_us);
+    }, nullptr, cfg::LOG_DRAIN_INTERVAL_MS * 1000u, cfg::TASK_LOG_BUDGET_US);
+    
+    // Desde aquí los registros del log esperan a su tarea
+    Log::set_deferred(true);
+    scheduler.run(); // No retorna
+}
@@ -1,12 +1,25 @@
 const express = require('express');
 const router = express.Router();
 const axios = require('axios');
+const batchFormat = require('../services/batchFormat');
 require('dotenv').config();
 
 // Configuración del Pico
 const PICO_IP = process.env.PICO_IP || '192.168.1.100'; // IP del Pico en la red local
 const PICO_PORT = process.env.PICO_PORT || 80;
 
+// Los lotes binarios del Pico llegan como application/octet-stream
+const rawBatch = express.raw({ type: 'application/octet-stream', limit: '64kb' });
+
+// Formas de onda en curso: el Pico trocea cada registro en varios lotes
+// (first_index / total_count). Se guardan por dispositivo y evento hasta
+// completarse; solo se conservan las más recientes.
+const MAX_PENDING_WAVEFORMS = 16;
+const pendingWaveforms = new Map();
+
+// Aceleración dinámica (m/s²) a partir de la cual un lote cuenta como sísmico
+const SEISMIC_THRESHOLD_MPS2 = 3.0;
+
 // Helper para hacer peticiones al Pico
 async function sendToPico(endpoint, params = {}) {
   try {
@@ -292,6 +305,110 @@ router.post('/status', async (req, res) => {
   }
 });
 
+// Endpoint para recibir lotes binarios de aceleración continua (filtrada,
+// sin gravedad) desde el Pico
+router.post('/sensor-batch', rawBatch, (req, res) => {
+  let batch;
+  try {
+    batch = batchFormat.decode(req.body);
+  } catch (error) {
+    return res.status(400).json({
+      success: false,
+      error: 'Lote de sensor inválido',
+      message: error.message
+    });
+  }
+
+  try {
+    const summary = batchFormat.summarize(batch);
+
+    console.log(`📊 Lote del sensor recibido - Device: ${summary.device_id}, ` +
+                `${summary.sample_count} muestras @ ${summary.sample_rate_hz} Hz, ` +
+                `pico ${summary.peak_acceleration.total} m/s²`);
+
+    // Mismo umbral que EARTHQUAKE_THRESHOLD en el firmware; las muestras
+    // ya vienen sin gravedad
+    const isSeismicEvent = summary.peak_acceleration.total >= SEISMIC_THRESHOLD_MPS2;
+    if (isSeismicEvent) {
+      console.log('🚨 ¡Evento sísmico detectado en el lote!');
+    }
+
+    res.json({
+      success: true,
+      message: 'Lote del sensor procesado correctamente',
+      data: {
+        ...summary,
+        is_seismic_event: isSeismicEvent
+      }
+    });
+  } catch (error) {
+    console.error('Error procesando lote del sensor:', error);
+    res.status(500).json({
+      success: false,
+      error: 'Error procesando lote del sensor',
+      message: error.message
+    });
+  }
+});
+
+// Endpoint para recibir la forma de onda de un evento (lotes binarios)
+router.post('/waveform', rawBatch, (req, res) => {
+  let batch;
+  try {
+    batch = batchFormat.decode(req.body);
+  } catch (error) {
+    return res.status(400).json({
+      success: false,
+      error: 'Lote de forma de onda inválido',
+      message: error.message
+    });
+  }
+
+  try {
+    const summary = batchFormat.summarize(batch);
+    const key = `${summary.device_id}:${summary.event_id}`;
+
+    let waveform = pendingWaveforms.get(key);
+    if (!waveform) {
+      if (pendingWaveforms.size >= MAX_PENDING_WAVEFORMS) {
+        pendingWaveforms.delete(pendingWaveforms.keys().next().value);
+      }
+      waveform = { total_count: summary.total_count, received: new Set(), samples: 0 };
+      pendingWaveforms.set(key, waveform);
+    }
+    // Un lote reenviado tras un fallo de red no cuenta dos veces
+    if (!waveform.received.has(summary.first_index)) {
+      waveform.received.add(summary.first_index);
+      waveform.samples += summary.sample_count;
+    }
+
+    const complete = waveform.samples >= waveform.total_count;
+    if (complete) pendingWaveforms.delete(key);
+
+    console.log(`🌊 Forma de onda - Device: ${summary.device_id}, evento ${summary.event_id}, ` +
+                `muestras ${summary.first_index}-${summary.first_index + summary.sample_count - 1} ` +
+                `de ${summary.total_count}, pico ${summary.peak_acceleration.total} m/s²` +
+                (complete ? ' (completa)' : ''));
+
+    res.json({
+      success: true,
+      message: 'Lote de forma de onda recibido',
+      data: {
+        ...summary,
+        received_samples: waveform.samples,
+        complete
+      }
+    });
+  } catch (error) {
+    console.error('Error procesando forma de onda:', error);
+    res.status(500).json({
+      success: false,
+      error: 'Error procesando forma de onda',
+      message: error.message
+    });
+  }
+});
+
 // Endpoint GET para información del endpoint sensor-data (para pruebas)
 router.get('/sensor-data', (req, res) => {
   res.json({
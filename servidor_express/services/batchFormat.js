@@ -0,0 +1,145 @@
+// Decodificador de los lotes binarios que envía el Pico
+// (lib/BatchFormat.h en el firmware; versión 1).
+//
+// Cabecera fija de 58 bytes little-endian seguida de las muestras: por cada
+// muestra, los tres ejes como diferencia con la anterior en zigzag + varint.
+
+const MAGIC = 'SB';
+const VERSION = 1;
+const CHANNELS = 3;
+const DEVICE_ID_LEN = 16;
+const HEADER_SIZE = 58;
+
+const KIND_CONTINUOUS = 0;
+const KIND_WAVEFORM = 1;
+
+const FLAG_FILTERED = 1 << 0;
+const FLAG_TRUNCATED = 1 << 1;
+
+/**
+ * Lee y valida la cabecera de un lote
+ * @param {Buffer} buf - Lote completo
+ * @returns {object} - Campos de la cabecera
+ */
+function readHeader(buf) {
+  if (!Buffer.isBuffer(buf) || buf.length < HEADER_SIZE) {
+    throw new Error('lote más corto que la cabecera');
+  }
+  if (buf.toString('latin1', 0, 2) !== MAGIC) {
+    throw new Error('magic incorrecto');
+  }
+
+  const header = {
+    version: buf.readUInt8(2),
+    kind: buf.readUInt8(3),
+    flags: buf.readUInt8(4),
+    channels: buf.readUInt8(5),
+    device_id: buf.toString('latin1', 6, 6 + DEVICE_ID_LEN).replace(/\0.*$/s, ''),
+    start_us: buf.readBigUInt64LE(22),
+    sample_rate_hz: buf.readUInt16LE(30),
+    counts_per_g: buf.readUInt16LE(32),
+    sample_count: buf.readUInt32LE(34),
+    event_id: buf.readUInt32LE(38),
+    first_index: buf.readUInt32LE(42),
+    total_count: buf.readUInt32LE(46),
+    trigger_index: buf.readUInt32LE(50),
+    sta_lta_ratio_q8: buf.readUInt32LE(54)
+  };
+
+  if (header.version !== VERSION) throw new Error('versión de formato no soportada');
+  if (header.channels !== CHANNELS) throw new Error('número de canales no soportado');
+  if (header.sample_rate_hz === 0) throw new Error('frecuencia de muestreo nula');
+  return header;
+}
+
+function zigzagDecode(v) {
+  return (v >>> 1) ^ -(v & 1);
+}
+
+/**
+ * Decodifica un lote completo. Rechaza lotes truncados y bytes sobrantes.
+ * @param {Buffer} buf - Lote completo
+ * @returns {{header: object, samples: Array<{x: number, y: number, z: number}>}}
+ */
+function decode(buf) {
+  const header = readHeader(buf);
+  const samples = [];
+  const prev = [0, 0, 0];
+  let pos = HEADER_SIZE;
+
+  const readVarint = () => {
+    let v = 0;
+    for (let shift = 0; shift < 35; shift += 7) {
+      if (pos >= buf.length) throw new Error('muestras truncadas');
+      const b = buf[pos++];
+      v = (v | ((b & 0x7F) << shift)) >>> 0;
+      if (!(b & 0x80)) return v;
+    }
+    throw new Error('muestras truncadas');
+  };
+
+  for (let i = 0; i < header.sample_count; i++) {
+    const v = [];
+    for (let c = 0; c < CHANNELS; c++) {
+      v[c] = prev[c] + zigzagDecode(readVarint());
+      if (v[c] < -32768 || v[c] > 32767) throw new Error('muestra fuera de rango');
+      prev[c] = v[c];
+    }
+    samples.push({ x: v[0], y: v[1], z: v[2] });
+  }
+
+  if (pos !== buf.length) throw new Error('bytes sobrantes tras las muestras');
+  return { header, samples };
+}
+
+/**
+ * Resumen de un lote decodificado: pico de |a| por eje y total, en m/s²
+ * @param {{header: object, samples: Array}} batch - Resultado de decode()
+ * @returns {object}
+ */
+function summarize(batch) {
+  const { header, samples } = batch;
+  const scale = 9.81 / (header.counts_per_g || 16384);
+  const peak = { x: 0, y: 0, z: 0, total: 0 };
+
+  for (const s of samples) {
+    peak.x = Math.max(peak.x, Math.abs(s.x));
+    peak.y = Math.max(peak.y, Math.abs(s.y));
+    peak.z = Math.max(peak.z, Math.abs(s.z));
+    peak.total = Math.max(peak.total, Math.sqrt(s.x * s.x + s.y * s.y + s.z * s.z));
+  }
+
+  const periodUs = 1e6 / header.sample_rate_hz;
+  const firstUs = Number(header.start_us) + header.first_index * periodUs;
+
+  return {
+    device_id: header.device_id,
+    kind: header.kind === KIND_WAVEFORM ? 'waveform' : 'continuous',
+    filtered: Boolean(header.flags & FLAG_FILTERED),
+    truncated: Boolean(header.flags & FLAG_TRUNCATED),
+    event_id: header.event_id,
+    sample_rate_hz: header.sample_rate_hz,
+    first_index: header.first_index,
+    sample_count: header.sample_count,
+    total_count: header.total_count,
+    trigger_index: header.trigger_index,
+    sta_lta_ratio: header.sta_lta_ratio_q8 / 256,
+    first_sample_us: firstUs,
+    last_sample_us: firstUs + Math.max(samples.length - 1, 0) * periodUs,
+    peak_acceleration: {
+      x: +(peak.x * scale).toFixed(4),
+      y: +(peak.y * scale).toFixed(4),
+      z: +(peak.z * scale).toFixed(4),
+      total: +(peak.total * scale).toFixed(4)
+    }
+  };
+}
+
+module.exports = {
+  HEADER_SIZE,
+  KIND_CONTINUOUS,
+  KIND_WAVEFORM,
+  readHeader,
+  decode,
+  summarize
+};
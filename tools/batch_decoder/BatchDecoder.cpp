@@ -0,0 +1,78 @@
+#include "BatchDecoder.h"
+#include <cstring>
+
+namespace batch {
+
+static bool fail(std::string* error, const char* msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+bool read_header(const uint8_t* data, size_t len, Header& h, std::string* error) {
+    if (!data || len < HEADER_SIZE) return fail(error, "lote más corto que la cabecera");
+    if (data[0] != MAGIC0 || data[1] != MAGIC1) return fail(error, "magic incorrecto");
+
+    h.version = data[2];
+    if (h.version != VERSION) return fail(error, "versión de formato no soportada");
+
+    h.kind = data[3];
+    h.flags = data[4];
+    h.channels = data[5];
+    if (h.channels != CHANNELS) return fail(error, "número de canales no soportado");
+
+    memcpy(h.device_id, data + 6, DEVICE_ID_LEN);
+    h.device_id[DEVICE_ID_LEN] = '\0';
+    h.start_us = get_le64(data + 22);
+    h.sample_rate_hz = get_le16(data + 30);
+    h.counts_per_g = get_le16(data + 32);
+    h.sample_count = get_le32(data + 34);
+    h.event_id = get_le32(data + 38);
+    h.first_index = get_le32(data + 42);
+    h.total_count = get_le32(data + 46);
+    h.trigger_index = get_le32(data + 50);
+    h.sta_lta_ratio_q8 = get_le32(data + 54);
+
+    if (h.sample_rate_hz == 0) return fail(error, "frecuencia de muestreo nula");
+    return true;
+}
+
+static bool read_varint(const uint8_t* data, size_t len, size_t& pos, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= len) return false;
+        uint8_t b = data[pos++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+bool decode(const uint8_t* data, size_t len, Batch& out, std::string* error) {
+    if (!read_header(data, len, out.header, error)) return false;
+
+    // Cada muestra ocupa al menos un byte por eje: una cuenta mayor no cabe
+    // en el lote (y reservarla podría agotar la memoria)
+    if (out.header.sample_count > (len - HEADER_SIZE) / CHANNELS) return fail(error, "muestras truncadas");
+
+    out.samples.clear();
+    out.samples.reserve(out.header.sample_count);
+
+    size_t pos = HEADER_SIZE;
+    int32_t prev[CHANNELS] = { 0, 0, 0 };
+    for (uint32_t i = 0; i < out.header.sample_count; i++) {
+        int32_t v[CHANNELS];
+        for (int c = 0; c < CHANNELS; c++) {
+            uint32_t raw;
+            if (!read_varint(data, len, pos, raw)) return fail(error, "muestras truncadas");
+            v[c] = prev[c] + zigzag_decode(raw);
+            if (v[c] < INT16_MIN || v[c] > INT16_MAX) return fail(error, "muestra fuera de rango");
+            prev[c] = v[c];
+        }
+        out.samples.push_back(Sample{ (int16_t)v[0], (int16_t)v[1], (int16_t)v[2] });
+    }
+
+    if (pos != len) return fail(error, "bytes sobrantes tras las muestras");
+    return true;
+}
+
+} // namespace batch
@@ -0,0 +1,37 @@
+#ifndef BATCH_DECODER_H_
+#define BATCH_DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../lib/BatchFormat.h"
+
+// Decodificador de host para los lotes binarios del Pico (lib/BatchFormat.h).
+namespace batch {
+
+    struct Sample {
+        int16_t x, y, z;   // cuentas; dividir por counts_per_g para tener g
+    };
+
+    struct Batch {
+        Header header;
+        std::vector<Sample> samples;
+
+        // Instante (µs) de la muestra i de este lote
+        uint64_t sample_time_us(size_t i) const {
+            return header.start_us +
+                   (uint64_t)(header.first_index + i) * 1000000ULL / header.sample_rate_hz;
+        }
+    };
+
+    // Lee y valida la cabecera. En error devuelve false y explica en *error.
+    bool read_header(const uint8_t* data, size_t len, Header& out, std::string* error = nullptr);
+
+    // Decodifica un lote completo. Rechaza versiones desconocidas, lotes
+    // truncados y bytes sobrantes tras la última muestra.
+    bool decode(const uint8_t* data, size_t len, Batch& out, std::string* error = nullptr);
+
+} // namespace batch
+
+#endif // BATCH_DECODER_H_
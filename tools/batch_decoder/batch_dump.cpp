@@ -0,0 +1,43 @@
+// Vuelca lotes binarios del Pico a CSV: t_us,x_g,y_g,z_g
+//
+//   batch_dump lote1.bin [lote2.bin ...]
+#include "BatchDecoder.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "uso: %s lote.bin [...]\n", argv[0]);
+        return 2;
+    }
+
+    int status = 0;
+    printf("t_us,x_g,y_g,z_g\n");
+    for (int a = 1; a < argc; a++) {
+        std::ifstream in(argv[a], std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        batch::Batch b;
+        std::string error;
+        if (!batch::decode(bytes.data(), bytes.size(), b, &error)) {
+            fprintf(stderr, "%s: %s\n", argv[a], error.c_str());
+            status = 1;
+            continue;
+        }
+
+        fprintf(stderr, "%s: %s, %s evento %u, %u muestras desde %u/%u @ %u Hz\n",
+                argv[a], b.header.device_id,
+                b.header.kind == batch::KIND_WAVEFORM ? "forma de onda" : "continuo",
+                b.header.event_id, b.header.sample_count,
+                b.header.first_index, b.header.total_count, b.header.sample_rate_hz);
+
+        double scale = b.header.counts_per_g ? 1.0 / b.header.counts_per_g : 1.0;
+        for (size_t i = 0; i < b.samples.size(); i++) {
+            const batch::Sample& s = b.samples[i];
+            printf("%llu,%.6f,%.6f,%.6f\n", (unsigned long long)b.sample_time_us(i),
+                   s.x * scale, s.y * scale, s.z * scale);
+        }
+    }
+    return status;
+}
@@ -0,0 +1,200 @@
+// Ida y vuelta BatchFormat (codificador del firmware) -> BatchDecoder.
+//
+// Codifica lotes aleatorios y casos límite, los decodifica y compara
+// cabecera y muestras. Sale con 1 en cuanto algo no coincide.
+#include "BatchDecoder.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using namespace batch;
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);     \
+            fprintf(stderr, __VA_ARGS__);                       \
+            fprintf(stderr, "\n");                              \
+            failures++;                                         \
+        }                                                       \
+    } while (0)
+
+static Header make_header(uint8_t kind, uint64_t start_us, uint32_t first_index, uint32_t total) {
+    Header h = {};
+    h.version = VERSION;
+    h.kind = kind;
+    h.flags = kind == KIND_CONTINUOUS ? FLAG_FILTERED : 0;
+    h.channels = CHANNELS;
+    strcpy(h.device_id, "pico_sensor_01");
+    h.start_us = start_us;
+    h.sample_rate_hz = 100;
+    h.counts_per_g = 16384;
+    h.event_id = kind == KIND_WAVEFORM ? 42 : 0;
+    h.first_index = first_index;
+    h.total_count = total;
+    h.trigger_index = 25;
+    h.sta_lta_ratio_q8 = 3 * 256 + 17;
+    return h;
+}
+
+// Codifica las muestras que quepan en capacity y comprueba la vuelta.
+// Devuelve cuántas entraron.
+static size_t roundtrip(const char* name, const Header& h, const std::vector<Sample>& in, size_t capacity) {
+    std::vector<uint8_t> buf(capacity);
+    Encoder enc;
+    if (!enc.begin(buf.data(), buf.size(), h)) {
+        CHECK(false, "%s: begin() rechazó el buffer", name);
+        return 0;
+    }
+    size_t n = 0;
+    while (n < in.size() && enc.add(in[n].x, in[n].y, in[n].z)) n++;
+    size_t len = enc.finish();
+
+    Batch out;
+    std::string error;
+    if (!decode(buf.data(), len, out, &error)) {
+        CHECK(false, "%s: decode falló: %s", name, error.c_str());
+        return n;
+    }
+
+    const Header& d = out.header;
+    CHECK(d.version == VERSION && d.kind == h.kind && d.flags == h.flags && d.channels == CHANNELS,
+          "%s: campos de formato distintos", name);
+    CHECK(strcmp(d.device_id, h.device_id) == 0, "%s: device_id '%s'", name, d.device_id);
+    CHECK(d.start_us == h.start_us, "%s: start_us", name);
+    CHECK(d.sample_rate_hz == h.sample_rate_hz && d.counts_per_g == h.counts_per_g, "%s: escala", name);
+    CHECK(d.sample_count == n, "%s: sample_count %u, esperado %zu", name, d.sample_count, n);
+    CHECK(d.event_id == h.event_id && d.first_index == h.first_index, "%s: event_id/first_index", name);
+    CHECK(d.total_count == (h.total_count ? h.total_count : n), "%s: total_count %u", name, d.total_count);
+    CHECK(d.trigger_index == h.trigger_index && d.sta_lta_ratio_q8 == h.sta_lta_ratio_q8,
+          "%s: disparo", name);
+
+    CHECK(out.samples.size() == n, "%s: %zu muestras decodificadas, esperadas %zu", name, out.samples.size(), n);
+    for (size_t i = 0; i < n && i < out.samples.size(); i++) {
+        const Sample& a = in[i];
+        const Sample& b = out.samples[i];
+        if (a.x != b.x || a.y != b.y || a.z != b.z) {
+            CHECK(false, "%s: muestra %zu (%d,%d,%d) != (%d,%d,%d)", name, i, a.x, a.y, a.z, b.x, b.y, b.z);
+            break;
+        }
+    }
+
+    // Un byte de menos o de más debe rechazarse
+    if (n > 0) {
+        CHECK(!decode(buf.data(), len - 1, out, &error), "%s: aceptó un lote truncado", name);
+    }
+    if (len < capacity) {
+        buf[len] = 0;
+        CHECK(!decode(buf.data(), len + 1, out, &error), "%s: aceptó bytes sobrantes", name);
+    }
+    return n;
+}
+
+int main() {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> any(INT16_MIN, INT16_MAX);
+    std::normal_distribution<double> noise(0.0, 40.0);
+
+    // Una muestra
+    roundtrip("una_muestra", make_header(KIND_CONTINUOUS, 1000, 0, 0), { { 12, -7, 16384 } }, 256);
+
+    // Lote vacío
+    roundtrip("vacio", make_header(KIND_CONTINUOUS, 1000, 0, 0), {}, HEADER_SIZE);
+
+    // Extremos de int16: cada diferencia es la mayor posible
+    {
+        std::vector<Sample> s;
+        for (int i = 0; i < 64; i++) {
+            int16_t v = (i & 1) ? INT16_MAX : INT16_MIN;
+            s.push_back({ v, (int16_t)(-1 - v), (int16_t)((i % 3) ? INT16_MIN : INT16_MAX) });
+        }
+        size_t n = roundtrip("min_max", make_header(KIND_WAVEFORM, 5, 0, 64), s, HEADER_SIZE + 64 * MAX_SAMPLE_BYTES);
+        CHECK(n == s.size(), "min_max: entraron %zu de %zu con capacidad para el peor caso", n, s.size());
+    }
+
+    // Lote lleno: se añade hasta que add() rechaza; el resto no debe colarse
+    {
+        std::vector<Sample> s(2000);
+        for (Sample& v : s) v = { (int16_t)any(rng), (int16_t)any(rng), (int16_t)any(rng) };
+        size_t n = roundtrip("lleno", make_header(KIND_WAVEFORM, 77, 0, 0), s, 1024);
+        CHECK(n > 0 && n < s.size(), "lleno: %zu muestras en 1024 bytes", n);
+    }
+
+    // Ruido de fondo alrededor de 1 g: casi todo en un byte por eje
+    {
+        std::vector<Sample> s(400);
+        for (Sample& v : s) {
+            v = { (int16_t)noise(rng), (int16_t)noise(rng), (int16_t)(16384 + noise(rng)) };
+        }
+        size_t n = roundtrip("ruido", make_header(KIND_CONTINUOUS, 99, 0, 0), s, 4096);
+        CHECK(n == s.size(), "ruido: entraron %zu de %zu", n, s.size());
+    }
+
+    // Registro troceado con huecos de tiempo entre lotes: cada lote se
+    // decodifica solo y sample_time_us sigue a first_index
+    {
+        const uint64_t start = 0xFFFFFFF0ull;   // cruza el desbordamiento de 32 bits
+        const uint32_t firsts[] = { 0, 150, 300, 10000, 4000000 };
+        for (uint32_t first : firsts) {
+            std::vector<Sample> s(150);
+            for (Sample& v : s) v = { (int16_t)any(rng), (int16_t)noise(rng), (int16_t)any(rng) };
+            Header h = make_header(KIND_WAVEFORM, start, first, 4000150);
+            std::vector<uint8_t> buf(HEADER_SIZE + s.size() * MAX_SAMPLE_BYTES);
+            roundtrip("huecos", h, s, buf.size());
+
+            Encoder enc;
+            enc.begin(buf.data(), buf.size(), h);
+            for (const Sample& v : s) enc.add(v.x, v.y, v.z);
+            Batch b;
+            if (decode(buf.data(), enc.finish(), b)) {
+                uint64_t expect = start + (uint64_t)(first + 149) * 1000000ULL / h.sample_rate_hz;
+                CHECK(b.sample_time_us(149) == expect, "huecos: t(%u+149) = %llu, esperado %llu", first,
+                      (unsigned long long)b.sample_time_us(149), (unsigned long long)expect);
+            }
+        }
+    }
+
+    // Lotes aleatorios de tamaño y capacidad variables
+    for (int round = 0; round < 200; round++) {
+        std::vector<Sample> s(std::uniform_int_distribution<int>(1, 300)(rng));
+        bool wild = round & 1;
+        for (Sample& v : s) {
+            v = wild ? Sample{ (int16_t)any(rng), (int16_t)any(rng), (int16_t)any(rng) }
+                     : Sample{ (int16_t)noise(rng), (int16_t)noise(rng), (int16_t)noise(rng) };
+        }
+        size_t cap = std::uniform_int_distribution<size_t>(HEADER_SIZE + MAX_SAMPLE_BYTES, 2048)(rng);
+        roundtrip("aleatorio", make_header(round % 2, rng(), rng() % 1000, 0), s, cap);
+    }
+
+    // Cabeceras inválidas
+    {
+        uint8_t buf[HEADER_SIZE + 16];
+        Encoder enc;
+        enc.begin(buf, sizeof(buf), make_header(KIND_CONTINUOUS, 0, 0, 0));
+        size_t len = enc.finish();
+        Batch b;
+        buf[0] = 'X';
+        CHECK(!decode(buf, len, b), "aceptó un magic incorrecto");
+        buf[0] = MAGIC0;
+        buf[2] = VERSION + 1;
+        CHECK(!decode(buf, len, b), "aceptó una versión desconocida");
+        buf[2] = VERSION;
+        CHECK(!decode(buf, HEADER_SIZE - 1, b), "aceptó una cabecera corta");
+
+        // Cuenta de muestras imposible para el tamaño del lote: se rechaza
+        // antes de reservar memoria
+        put_le32(buf + 34, 0xFFFFFFFFu);
+        CHECK(!decode(buf, HEADER_SIZE, b), "aceptó sample_count 0xFFFFFFFF en un lote vacío");
+        put_le32(buf + 34, 6);
+        CHECK(!decode(buf, len, b), "aceptó más muestras de las que caben");
+    }
+
+    if (failures) {
+        fprintf(stderr, "%d comprobaciones fallidas\n", failures);
+        return 1;
+    }
+    printf("ida y vuelta OK\n");
+    return 0;
+}
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Genera web_assets.hpp a partir de web_page.hpp.
+
+Cada literal R"WEBPAGE(...)WEBPAGE" de web_page.hpp (inline constexpr const
+char kNombre[]) se comprime con gzip y se emite como arrays constexpr que
+quedan en flash:
+
+    web::kNombreGz[]      bytes gzip
+    web::kNombreGzLen     longitud
+    web::kNombreEtag[]    ETag fuerte ("crc32-longitud" del contenido original)
+
+La salida es determinista (mtime=0) para que el ETag solo cambie si cambia
+la página. Uso: gen_web_assets.py <web_page.hpp> <web_assets.hpp>
+"""
+
+import gzip
+import re
+import sys
+import zlib
+
+ASSET_RE = re.compile(
+    r'inline\s+constexpr\s+const\s+char\s+(k\w+)\[\]\s*=\s*R"(\w*)\((.*?)\)\2";',
+    re.S)
+
+
+def emit_bytes(data, indent='    ', per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        chunk = data[i:i + per_line]
+        lines.append(indent + ', '.join('0x%02x' % b for b in chunk) + ',')
+    return '\n'.join(lines)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('uso: %s <web_page.hpp> <web_assets.hpp>\n' % argv[0])
+        return 2
+
+    with open(argv[1], encoding='utf-8') as f:
+        source = f.read()
+
+    assets = ASSET_RE.findall(source)
+    if not assets:
+        sys.stderr.write('%s: no hay literales R"(...)" que comprimir\n' % argv[1])
+        return 1
+
+    out = [
+        '// Generado por tools/gen_web_assets.py a partir de web_page.hpp. No editar.',
+        '#ifndef WEB_ASSETS_HPP',
+        '#define WEB_ASSETS_HPP',
+        '',
+        '#include <cstddef>',
+        '#include <cstdint>',
+        '',
+        'namespace web {',
+    ]
+    for name, _delim, text in assets:
+        raw = text.encode('utf-8')
+        gz = gzip.compress(raw, compresslevel=9, mtime=0)
+        etag = '%08x-%x' % (zlib.crc32(raw) & 0xffffffff, len(raw))
+        out += [
+            '',
+            '// %s: %d bytes -> %d bytes gzip' % (name, len(raw), len(gz)),
+            'inline constexpr uint8_t %sGz[] = {' % name,
+            emit_bytes(gz),
+            '};',
+            'inline constexpr std::size_t %sGzLen = sizeof(%sGz);' % (name, name),
+            'inline constexpr char %sEtag[] = "\\"%s\\"";' % (name, etag),
+        ]
+    out += ['', '} // namespace web', '', '#endif // WEB_ASSETS_HPP', '']
+
+    with open(argv[2], 'w', encoding='utf-8') as f:
+        f.write('\n'.join(out))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -46,8 +46,54 @@ inline constexpr const char kIndexHtml[] = R"WEBPAGE(
                 });
         }
         
-        setInterval(updateSensorData, 1000); // Update every second
-        window.onload = updateSensorData;
+        // Stream en vivo (/api/stream): una conexión para todas las
+        // actualizaciones. Si no hay EventSource o el Pico rechaza la
+        // suscripción, se vuelve a consultar /api/sensor cada segundo.
+        let pollTimer = null;
+        function startPolling() {
+            document.getElementById('mode').textContent = 'consulta cada 1 s';
+            if (!pollTimer) pollTimer = setInterval(updateSensorData, 1000);
+        }
+
+        function startStream() {
+            updateSensorData();
+            if (!window.EventSource) { startPolling(); return; }
+            const es = new EventSource('/api/stream');
+            es.onopen = () => {
+                document.getElementById('mode').textContent = 'en vivo (aceleración filtrada)';
+            };
+            es.addEventListener('samples', e => {
+                const d = JSON.parse(e.data);
+                const k = 9.80665 / d.cpg;
+                const i = d.ax.length - 1;
+                const x = d.ax[i] * k, y = d.ay[i] * k, z = d.az[i] * k;
+                document.getElementById('accel-x').textContent = x.toFixed(3);
+                document.getElementById('accel-y').textContent = y.toFixed(3);
+                document.getElementById('accel-z').textContent = z.toFixed(3);
+                document.getElementById('magnitude').textContent = Math.sqrt(x*x + y*y + z*z).toFixed(3);
+                document.getElementById('status').textContent = 'online';
+                document.getElementById('status').className = 'status-online';
+                document.getElementById('timestamp').textContent = new Date().toLocaleTimeString();
+            });
+            es.addEventListener('trigger', e => {
+                const d = JSON.parse(e.data);
+                document.getElementById('last-event').textContent =
+                    d.type + ' (' + d.magnitude.toFixed(2) + ' m/s², STA/LTA ' + d.sta_lta.toFixed(1) + ') ' +
+                    new Date().toLocaleTimeString();
+            });
+            es.addEventListener('summary', e => {
+                const d = JSON.parse(e.data);
+                const pga = Math.max(d.pga[0], d.pga[1], d.pga[2]);
+                document.getElementById('last-event').textContent =
+                    d.type + ' #' + d.id + ' terminado: ' + (d.duration_ms / 1000).toFixed(1) + ' s, PGA ' +
+                    pga.toFixed(2) + ' m/s² ' + new Date().toLocaleTimeString();
+            });
+            es.onerror = () => {
+                if (es.readyState === EventSource.CLOSED) startPolling();
+            };
+        }
+
+        window.onload = startStream;
     </script>
 </head>
 <body>
@@ -66,6 +112,8 @@ inline constexpr const char kIndexHtml[] = R"WEBPAGE(
             <p><strong>Magnitud:</strong> <span id="magnitude" class="sensor-value">--</span> m/s²</p>
             <p><strong>Estado:</strong> <span id="status" class="status-offline">--</span></p>
             <p><strong>Última actualización:</strong> <span id="timestamp">--</span></p>
+            <p><strong>Último evento:</strong> <span id="last-event" class="sensor-value">--</span></p>
+            <p><strong>Modo:</strong> <span id="mode">--</span></p>
         </div>
         
         <button class="refresh-btn" onclick="updateSensorData()">🔄 Actualizar</button>